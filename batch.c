@@ -0,0 +1,455 @@
+/**
+ * Batch Engine
+ *
+ * Simulates the small workloads of a batch file BATCH_LANES at a time, one
+ * per lane, all advancing a tick per step. Every field of the lanes is kept
+ * as an array over the lanes, so finding the processes that arrive and the
+ * io that completes at each lane's tick is a loop over contiguous ints the
+ * compiler turns into vector compares, the results landing in one bit mask
+ * per lane. What follows differs from lane to lane and runs lane by lane on
+ * those masks, with the ready queue of every lane in a fixed ring and no
+ * allocation once the lanes are set up.
+ *
+ * Each lane replays FCFS on the policy engine or rrr step for step, so a
+ * workload gets the same finishing time, utilization and turnarounds as when
+ * it is run alone on the tick engine. Lanes that finish wait for the rest of their group,
+ * whose results are then written in input order.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "batch.h"
+
+// ring size of the lanes' ready queues, rrr can hold every process and the one it puts back
+#define BATCH_QUEUE_SIZE 64
+// the queues' NULL, rrr with a quantum below 1 puts an idle cpu back
+#define NO_PROCESS -1
+
+typedef struct BatchLanes {
+    // per process then per lane, the processes of a lane in sort_process_list order
+    int process_id[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int cpu_time[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int io_time[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int arrival_time[BATCH_MAX_PROCESSES][BATCH_LANES]; // -1 past the lane's last process
+    int status[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int spent_cpu_time[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int spent_io_time[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int execution_status[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int turnaround[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int io_deadline[BATCH_MAX_PROCESSES][BATCH_LANES];
+    int block_seq[BATCH_MAX_PROCESSES][BATCH_LANES];
+    signed char queue[BATCH_QUEUE_SIZE][BATCH_LANES];
+    // per lane
+    int queue_head[BATCH_LANES];
+    int queue_count[BATCH_LANES];
+    int no_of_processes[BATCH_LANES];
+    int active[BATCH_LANES];
+    int tick[BATCH_LANES];
+    int running[BATCH_LANES];
+    int run_time[BATCH_LANES];
+    int idle_count[BATCH_LANES];
+    int finished_count[BATCH_LANES];
+    int retry[BATCH_LANES]; // rrr goes over the tick again without its arrivals and io
+    int next_seq[BATCH_LANES];
+    uint32_t blocked[BATCH_LANES];
+    // found for the lane's current tick
+    uint32_t arrived[BATCH_LANES];
+    uint32_t woken[BATCH_LANES];
+    // results
+    int finishing_time[BATCH_LANES];
+    double cpu_utilization[BATCH_LANES];
+} BatchLanes;
+
+static void lane_enque(BatchLanes *b, int lane, int process) {
+    int tail = (b->queue_head[lane] + b->queue_count[lane]) & (BATCH_QUEUE_SIZE - 1);
+    b->queue[tail][lane] = (signed char) process;
+    b->queue_count[lane]++;
+}
+
+static int lane_deque(BatchLanes *b, int lane) {
+    if (b->queue_count[lane] == 0) {
+        return NO_PROCESS;
+    }
+    int process = b->queue[b->queue_head[lane]][lane];
+    b->queue_head[lane] = (b->queue_head[lane] + 1) & (BATCH_QUEUE_SIZE - 1);
+    b->queue_count[lane]--;
+    return process;
+}
+
+/**
+ * Fills in the masks of the processes arriving and waking up at each lane's
+ * tick, for every lane at once
+ */
+static void find_events(BatchLanes *b, int max_processes) {
+    int p, lane;
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        b->arrived[lane] = 0;
+        b->woken[lane] = 0;
+    }
+    for (p = 0; p < max_processes; p++) {
+        for (lane = 0; lane < BATCH_LANES; lane++) {
+            b->arrived[lane] |= (uint32_t) (b->arrival_time[p][lane] == b->tick[lane]) << p;
+            b->woken[lane] |= (uint32_t) (b->io_deadline[p][lane] <= b->tick[lane]) << p;
+        }
+    }
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        b->woken[lane] &= b->blocked[lane];
+    }
+}
+
+static void lane_block(BatchLanes *b, int lane, int p, int deadline) {
+    b->io_deadline[p][lane] = deadline;
+    b->block_seq[p][lane] = b->next_seq[lane]++;
+    b->blocked[lane] |= 1u << p;
+}
+
+// orders a lane's woken processes the way get_io_completed_processes does, by when they blocked
+static void sort_by_block_seq(BatchLanes *b, int lane, int *woken, int count) {
+    int i, j, p;
+    for (i = 1; i < count; i++) {
+        p = woken[i];
+        for (j = i; j > 0 && b->block_seq[woken[j - 1]][lane] > b->block_seq[p][lane]; j--) {
+            woken[j] = woken[j - 1];
+        }
+        woken[j] = p;
+    }
+}
+
+// then stable by process id, as sort_process_list_by_id does
+static void sort_by_id(BatchLanes *b, int lane, int *woken, int count) {
+    int i, j, p;
+    for (i = 1; i < count; i++) {
+        p = woken[i];
+        for (j = i; j > 0 && b->process_id[woken[j - 1]][lane] > b->process_id[p][lane]; j--) {
+            woken[j] = woken[j - 1];
+        }
+        woken[j] = p;
+    }
+}
+
+// a lane's woken processes, their io done
+static int take_woken(BatchLanes *b, int lane, int *woken) {
+    uint32_t mask = b->woken[lane];
+    int count = 0;
+    b->blocked[lane] &= ~mask;
+    while (mask != 0) {
+        woken[count++] = __builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+    sort_by_block_seq(b, lane, woken, count);
+    return count;
+}
+
+// one tick of FCFS on the policy engine, see policy_tick
+static void fcfs_step(BatchLanes *b, int lane) {
+    int arrived[BATCH_MAX_PROCESSES], woken[BATCH_MAX_PROCESSES];
+    int arrived_count = 0, woken_count, i, j, p;
+    int tick = b->tick[lane];
+    uint32_t mask = b->arrived[lane];
+
+    // in sort order, so processes arriving together come by process id
+    while (mask != 0) {
+        p = __builtin_ctz(mask);
+        mask &= mask - 1;
+        b->status[p][lane] = READY;
+        b->turnaround[p][lane] = tick;
+        arrived[arrived_count++] = p;
+    }
+    woken_count = take_woken(b, lane, woken);
+    for (i = 0; i < woken_count; i++) {
+        b->spent_io_time[woken[i]][lane] = b->io_time[woken[i]][lane];
+        b->status[woken[i]][lane] = READY;
+    }
+
+    p = b->running[lane];
+    if (p != NO_PROCESS) {
+        int spent = ++b->spent_cpu_time[p][lane];
+        if (spent == b->cpu_time[p][lane] * 2) {
+            b->status[p][lane] = TERMINATED;
+            b->turnaround[p][lane] = tick - b->turnaround[p][lane];
+            b->finished_count[lane]++;
+            b->running[lane] = NO_PROCESS;
+        } else if (spent == b->cpu_time[p][lane] && b->io_time[p][lane] != 0) {
+            b->status[p][lane] = BLOCKING;
+            if (b->io_time[p][lane] > b->spent_io_time[p][lane]) {
+                lane_block(b, lane, p, tick + b->io_time[p][lane] - b->spent_io_time[p][lane]);
+            }
+            b->running[lane] = NO_PROCESS;
+        }
+    }
+
+    // merged by process id, an arrival first if a woken process has the same id
+    sort_by_id(b, lane, woken, woken_count);
+    i = j = 0;
+    while (i < arrived_count || j < woken_count) {
+        if (i == arrived_count ||
+            (j < woken_count && b->process_id[woken[j]][lane] < b->process_id[arrived[i]][lane])) {
+            lane_enque(b, lane, woken[j++]);
+        } else {
+            lane_enque(b, lane, arrived[i++]);
+        }
+    }
+
+    if (b->running[lane] == NO_PROCESS) {
+        p = lane_deque(b, lane);
+        b->running[lane] = p;
+        if (p != NO_PROCESS) {
+            b->status[p][lane] = RUNNING;
+        } else {
+            b->idle_count[lane]++;
+        }
+    }
+    b->tick[lane] = tick + 1;
+
+    if (b->finished_count[lane] == b->no_of_processes[lane]) {
+        int finishing_time = tick + 1 - 2;
+        b->finishing_time[lane] = finishing_time;
+        b->cpu_utilization[lane] = ((finishing_time - (b->idle_count[lane] - 1)) * 1.0) / finishing_time;
+        b->active[lane] = 0;
+    }
+}
+
+// one iteration of rrr's loop
+static void rr_step(BatchLanes *b, int lane, int quantum) {
+    int woken[BATCH_MAX_PROCESSES];
+    int woken_count, i, p;
+    int tick = b->tick[lane];
+    uint32_t mask;
+
+    if (!b->retry[lane]) {
+        mask = b->arrived[lane];
+        while (mask != 0) {
+            p = __builtin_ctz(mask);
+            mask &= mask - 1;
+            b->status[p][lane] = READY;
+            b->turnaround[p][lane] = tick;
+            b->execution_status[p][lane] = 0;
+            lane_enque(b, lane, p);
+        }
+        woken_count = take_woken(b, lane, woken);
+        for (i = 0; i < woken_count; i++) {
+            p = woken[i];
+            b->spent_io_time[p][lane] = b->io_time[p][lane] > b->spent_io_time[p][lane] ?
+                                        b->io_time[p][lane] : b->spent_io_time[p][lane] + 1;
+            b->execution_status[p][lane] = 2;
+            b->status[p][lane] = READY;
+            b->spent_cpu_time[p][lane] = 0;
+            lane_enque(b, lane, p);
+        }
+    }
+    b->retry[lane] = 0;
+
+    p = b->running[lane];
+    if (p == NO_PROCESS) {
+        p = lane_deque(b, lane);
+    }
+    if (b->run_time[lane] >= quantum) {
+        lane_enque(b, lane, p);
+        p = lane_deque(b, lane);
+        b->run_time[lane] = 0;
+    }
+    b->running[lane] = p;
+
+    if (p == NO_PROCESS) {
+        b->tick[lane] = tick + 1;
+        b->idle_count[lane]++;
+        return;
+    }
+    switch (b->status[p][lane]) {
+        case RUNNING:
+            if (b->spent_cpu_time[p][lane] >= b->cpu_time[p][lane]) {
+                if (b->execution_status[p][lane] == 2) {
+                    b->status[p][lane] = TERMINATED;
+                    b->turnaround[p][lane] = tick - 1;
+                    b->finished_count[lane]++;
+                    b->run_time[lane] = 0;
+                    b->running[lane] = lane_deque(b, lane);
+                    b->retry[lane] = 1;
+                    if (b->finished_count[lane] == b->no_of_processes[lane]) {
+                        b->finishing_time[lane] = tick - 1;
+                        b->cpu_utilization[lane] = ((tick - b->idle_count[lane]) * 1.0) / tick;
+                        b->active[lane] = 0;
+                    }
+                    return;
+                } else if (b->io_time[p][lane] > 0) {
+                    int remaining = b->io_time[p][lane] - b->spent_io_time[p][lane];
+                    b->status[p][lane] = BLOCKING;
+                    lane_block(b, lane, p, tick + (remaining > 1 ? remaining : 1));
+                    b->spent_cpu_time[p][lane] = 0;
+                    b->running[lane] = lane_deque(b, lane);
+                    b->retry[lane] = 1;
+                    return;
+                } else {
+                    b->execution_status[p][lane] = 2;
+                    b->spent_cpu_time[p][lane] = 1;
+                }
+            } else {
+                b->spent_cpu_time[p][lane]++;
+            }
+            break;
+        case READY:
+            if (b->execution_status[p][lane] == 0 || b->execution_status[p][lane] == 2) {
+                b->status[p][lane] = RUNNING;
+                b->spent_cpu_time[p][lane]++;
+            } else {
+                b->status[p][lane] = BLOCKING;
+                b->spent_io_time[p][lane]++;
+                int remaining = b->io_time[p][lane] - b->spent_io_time[p][lane];
+                lane_block(b, lane, p, tick + (remaining > 1 ? remaining : 1));
+                b->running[lane] = lane_deque(b, lane);
+            }
+            break;
+        case BLOCKING:
+            if (b->spent_io_time[p][lane] >= b->io_time[p][lane]) {
+                b->status[p][lane] = RUNNING;
+                b->execution_status[p][lane] = 2;
+                b->spent_cpu_time[p][lane] = 1;
+            }
+            break;
+        default:
+            break;
+    }
+    b->run_time[lane]++;
+    b->tick[lane] = tick + 1;
+}
+
+/**
+ * The engines the lanes replay never finish a workload with a process that doesn't
+ * arrive, nor under FCFS one with a process without cpu time or with
+ * negative io time
+ */
+static int batch_workload_finishes(int alg_type, Process **process_list, int no_of_processes) {
+    int i;
+    for (i = 0; i < no_of_processes; i++) {
+        if (process_list[i]->arrival_time < 0) {
+            return 0;
+        }
+        if (alg_type == FCFS_ALGORITHM && (process_list[i]->cpu_time < 1 || process_list[i]->io_time < 0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void load_lane(BatchLanes *b, int lane, Process **process_list, int no_of_processes) {
+    int p;
+    for (p = 0; p < BATCH_MAX_PROCESSES; p++) {
+        Process *process = p < no_of_processes ? process_list[p] : NULL;
+        b->process_id[p][lane] = process != NULL ? process->process_id : 0;
+        b->cpu_time[p][lane] = process != NULL ? process->cpu_time : 0;
+        b->io_time[p][lane] = process != NULL ? process->io_time : 0;
+        b->arrival_time[p][lane] = process != NULL ? process->arrival_time : -1;
+        b->status[p][lane] = NONE;
+        b->spent_cpu_time[p][lane] = 0;
+        b->spent_io_time[p][lane] = 0;
+        b->execution_status[p][lane] = 0;
+        b->turnaround[p][lane] = 0;
+        b->io_deadline[p][lane] = 0;
+        b->block_seq[p][lane] = 0;
+    }
+    b->queue_head[lane] = b->queue_count[lane] = 0;
+    b->no_of_processes[lane] = no_of_processes;
+    b->active[lane] = no_of_processes > 0;
+    b->tick[lane] = 0;
+    b->running[lane] = NO_PROCESS;
+    b->run_time[lane] = 0;
+    b->idle_count[lane] = 0;
+    b->finished_count[lane] = 0;
+    b->retry[lane] = 0;
+    b->next_seq[lane] = 0;
+    b->blocked[lane] = 0;
+}
+
+static void write_lane(BatchLanes *b, int lane, Timeline *timeline, int alg_type) {
+    int p;
+    timeline_summary(timeline, b->finishing_time[lane], b->cpu_utilization[lane]);
+    for (p = 0; p < b->no_of_processes[lane]; p++) {
+        int turnaround = b->turnaround[p][lane];
+        if (alg_type != FCFS_ALGORITHM) {
+            turnaround = turnaround - b->arrival_time[p][lane] + 1;
+        }
+        timeline_turnaround(timeline, b->process_id[p][lane], turnaround);
+    }
+    timeline_next_summary(timeline);
+}
+
+/**
+ * Runs every workload of the batch file input under the context's FCFS or RR
+ * and writes one summary per workload, in the order of the file. Workloads
+ * with more than BATCH_MAX_PROCESSES processes or that would never finish are
+ * skipped, with a note on stderr
+ * returns the number of workloads run, or -1 if there is not enough memory
+ */
+int run_batch(SchedulerContext *context, WorkloadStream *input) {
+    BatchLanes *b = malloc(sizeof(BatchLanes));
+    INSTRUMENT_COUNT(allocations);
+    if (b == NULL) {
+        return -1;
+    }
+    int fcfs = context->alg_type == FCFS_ALGORITHM;
+    Process processes[BATCH_MAX_PROCESSES];
+    Process *process_list[BATCH_MAX_PROCESSES];
+    int lanes, lane, count, active, max_processes, i;
+    int read = 0, run = 0, more = 1;
+
+    Timeline timeline;
+    timeline_init(&timeline, context->out, fcfs ? FCFS_TIMELINE : RR_TIMELINE, TIMELINE_NONE,
+                  context->summary_format, NULL, NULL, 0);
+    timeline.writer = context->writer;
+
+    while (more) {
+        lanes = max_processes = 0;
+        while (lanes < BATCH_LANES) {
+            count = read_batched_workload(input, processes, BATCH_MAX_PROCESSES);
+            if (count == 0) {
+                more = 0;
+                break;
+            }
+            read++;
+            if (count < 0) {
+                fprintf(stderr, "Workload %d skipped, more than %d processes\n", read, BATCH_MAX_PROCESSES);
+                continue;
+            }
+            for (i = 0; i < count; i++) {
+                process_list[i] = &processes[i];
+            }
+            sort_process_list(process_list, count);
+            if (!batch_workload_finishes(context->alg_type, process_list, count)) {
+                fprintf(stderr, "Workload %d skipped, it would never finish\n", read);
+                continue;
+            }
+            load_lane(b, lanes, process_list, count);
+            if (count > max_processes) {
+                max_processes = count;
+            }
+            lanes++;
+        }
+        for (lane = lanes; lane < BATCH_LANES; lane++) {
+            load_lane(b, lane, process_list, 0);
+        }
+
+        do {
+            find_events(b, max_processes);
+            active = 0;
+            for (lane = 0; lane < lanes; lane++) {
+                if (!b->active[lane]) {
+                    continue;
+                }
+                if (fcfs) {
+                    fcfs_step(b, lane);
+                } else {
+                    rr_step(b, lane, context->quantum);
+                }
+                active += b->active[lane];
+            }
+        } while (active > 0);
+
+        for (lane = 0; lane < lanes; lane++) {
+            write_lane(b, lane, &timeline, context->alg_type);
+        }
+        run += lanes;
+    }
+    timeline_finish(&timeline);
+    free(b);
+    return run;
+}
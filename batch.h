@@ -0,0 +1,17 @@
+/**
+ * Batch Engine
+ */
+
+#ifndef SCHEDULERS_BATCH_H
+#define SCHEDULERS_BATCH_H
+#include "loader.h"
+#include "scheduler.h"
+
+// the most processes a workload of a batch can have, each lane keeps its processes in a bit mask
+#define BATCH_MAX_PROCESSES 32
+// workloads simulated side by side
+#define BATCH_LANES 64
+
+int run_batch(SchedulerContext *context, WorkloadStream *input);
+
+#endif //SCHEDULERS_BATCH_H
@@ -0,0 +1,252 @@
+/**
+ * Scheduler Benchmark
+ *
+ * Generates seeded workloads and times each stage on its own: loading the
+ * processes info file, sorting it, simulating with the summary only, and the
+ * extra time writing the full timeline takes. Every algorithm runs on both
+ * the tick engines (run_policy, rrr) and the event engines. The baseline holds
+ * the event engine's throughput as a multiple of the tick engine's on the same
+ * workload and algorithm, which carries over from one machine to another
+ * where absolute ticks per second do not, and the run fails if any of it
+ * dropped by more than the tolerance.
+ *
+ * build: make sched_bench
+ * run:   ./sched_bench [--max-processes=N] [--baseline=bench/baseline.csv] [--write-baseline=FILE]
+ *                      [--tolerance=0.5]
+ *
+ * bench/baseline.csv is regenerated with make baseline, its tolerance of 0.5
+ * lets a multiple fall to half of what is stored before it counts as a regression.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../generator.h"
+#include "../loader.h"
+#include "../scheduler.h"
+
+// every measurement is the best of this many runs
+#define REPEATS 3
+// the full timeline grows with processes times ticks, it is only timed up to this many processes
+#define MAX_TIMELINE_PROCESSES 10000
+#define MAX_RESULTS 256
+// runs shorter than this are all noise, they are reported but never flagged as regressions
+#define MIN_CHECKED_TIME 0.001
+
+typedef struct BenchWorkload {
+    const char *name;
+    long long no_of_processes;
+    int arrivals;
+    int bursts;
+} BenchWorkload;
+
+// the event engine against the tick engine on one workload and algorithm
+typedef struct BenchResult {
+    char name[96];
+    double speedup;
+} BenchResult;
+
+static const BenchWorkload workloads[] = {
+    {"poisson-uniform-10", 10, POISSON_ARRIVALS, UNIFORM_BURSTS},
+    {"poisson-uniform-1k", 1000, POISSON_ARRIVALS, UNIFORM_BURSTS},
+    {"bursty-pareto-1k", 1000, BURSTY_ARRIVALS, PARETO_BURSTS},
+    {"poisson-uniform-100k", 100000, POISSON_ARRIVALS, UNIFORM_BURSTS},
+    {"bursty-pareto-100k", 100000, BURSTY_ARRIVALS, PARETO_BURSTS},
+    {"poisson-uniform-1m", 1000000, POISSON_ARRIVALS, UNIFORM_BURSTS},
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Runs one configuration REPEATS times on a fresh context
+ * returns the best time, the finishing time is left in finishing_time
+ */
+static double time_run(Process **process_list, int no_of_processes, int alg_type, int engine,
+                       int timeline_mode, FILE *out, int *finishing_time) {
+    SchedulerContext context;
+    double best = -1, start, elapsed;
+    int repeat;
+    for (repeat = 0; repeat < REPEATS; repeat++) {
+        init_scheduler_context(&context, process_list, no_of_processes);
+        context.alg_type = alg_type;
+        context.quantum = 4;
+        context.engine = engine;
+        context.timeline_mode = timeline_mode;
+        context.out = out;
+        start = now();
+        run_scheduler(&context);
+        elapsed = now() - start;
+        *finishing_time = context.finishing_time;
+        free_scheduler_context(&context);
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static int load_baseline(const char *file_name, BenchResult *baseline) {
+    FILE *f = fopen(file_name, "r");
+    int count = 0;
+    if (f == NULL) {
+        return -1;
+    }
+    while (count < MAX_RESULTS && fscanf(f, "%95[^,],%lf\n", baseline[count].name,
+                                         &baseline[count].speedup) == 2) {
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    long long max_processes = 100000;
+    const char *baseline_file = NULL, *write_baseline_file = NULL;
+    double tolerance = 0.5;
+    BenchResult results[MAX_RESULTS], baseline[MAX_RESULTS];
+    int no_of_results = 0, no_of_baseline = 0, regressions = 0;
+    char file_name[] = "/tmp/sched_bench_XXXXXX";
+    FILE *null_out;
+    int arg, w, i, fd;
+
+    for (arg = 1; arg < argc; arg++) {
+        if (strncmp(argv[arg], "--max-processes=", 16) == 0) {
+            max_processes = atoll(argv[arg] + 16);
+        } else if (strncmp(argv[arg], "--baseline=", 11) == 0) {
+            baseline_file = argv[arg] + 11;
+        } else if (strncmp(argv[arg], "--write-baseline=", 17) == 0) {
+            write_baseline_file = argv[arg] + 17;
+        } else if (strncmp(argv[arg], "--tolerance=", 12) == 0) {
+            tolerance = atof(argv[arg] + 12);
+        } else {
+            printf("unknown argument %s\n", argv[arg]);
+            return 1;
+        }
+    }
+    if (baseline_file != NULL && (no_of_baseline = load_baseline(baseline_file, baseline)) < 0) {
+        printf("%s not found\n", baseline_file);
+        return 1;
+    }
+
+    fd = mkstemp(file_name);
+    if (fd < 0) {
+        printf("could not create a temporary file\n");
+        return 1;
+    }
+    close(fd);
+    null_out = fopen("/dev/null", "w");
+
+    printf("%-22s %-10s %-6s %10s %10s %10s %10s %14s %14s %8s\n", "workload", "engine", "alg", "load s", "sort s",
+           "sim s", "output s", "ticks/s", "processes/s", "vs tick");
+    for (w = 0; w < (int) (sizeof(workloads) / sizeof(workloads[0])); w++) {
+        const BenchWorkload *bench = &workloads[w];
+        GeneratorOptions options;
+        Workload workload;
+        FILE *f;
+        double load_time, sort_time, start;
+
+        if (bench->no_of_processes > max_processes) {
+            continue;
+        }
+
+        default_generator_options(&options);
+        options.seed = 42 + w;
+        options.no_of_processes = bench->no_of_processes;
+        options.arrivals = bench->arrivals;
+        options.bursts = bench->bursts;
+        f = fopen(file_name, "w");
+        generate_workload(f, &options);
+        fclose(f);
+
+        start = now();
+        if (load_workload(&workload, file_name) != LOAD_OK) {
+            printf("%s could not be loaded\n", bench->name);
+            return 1;
+        }
+        load_time = now() - start;
+        // the generator writes processes in arrival order, shuffle them so the sort has work to do
+        srand(w);
+        for (i = workload.no_of_processes - 1; i > 0; i--) {
+            int j = rand() % (i + 1);
+            Process *temp = workload.process_list[i];
+            workload.process_list[i] = workload.process_list[j];
+            workload.process_list[j] = temp;
+        }
+        start = now();
+        sort_process_list(workload.process_list, workload.no_of_processes);
+        sort_time = now() - start;
+
+        int alg_type, engine, finishing_time;
+        for (alg_type = FCFS_ALGORITHM; alg_type <= RR_ALGORITHM; alg_type++) {
+            double tick_time = 0;
+            for (engine = TICK_ENGINE; engine <= EVENT_ENGINE; engine++) {
+                double sim_time, output_time = -1, ticks_per_sec;
+                sim_time = time_run(workload.process_list, workload.no_of_processes, alg_type, engine,
+                                    TIMELINE_NONE, NULL, &finishing_time);
+                if (workload.no_of_processes <= MAX_TIMELINE_PROCESSES) {
+                    output_time = time_run(workload.process_list, workload.no_of_processes, alg_type, engine,
+                                           TIMELINE_FULL, null_out, &finishing_time) - sim_time;
+                    if (output_time < 0) {
+                        output_time = 0;
+                    }
+                }
+                ticks_per_sec = sim_time > 0 ? finishing_time / sim_time : 0;
+
+                printf("%-22s %-10s %-6s %10.6f %10.6f %10.6f ", bench->name,
+                       engine == EVENT_ENGINE ? "event" : "tick", algorithm_name(alg_type), load_time, sort_time, sim_time);
+                if (output_time >= 0) {
+                    printf("%10.6f ", output_time);
+                } else {
+                    printf("%10s ", "-");
+                }
+                printf("%14.0f %14.0f", ticks_per_sec,
+                       sim_time > 0 ? workload.no_of_processes / sim_time : 0);
+                if (engine == TICK_ENGINE) {
+                    tick_time = sim_time;
+                    printf("\n");
+                    continue;
+                }
+                // both engines simulate the same ticks, so the ratio of their times is the ratio of their throughputs
+                double speedup = sim_time > 0 ? tick_time / sim_time : 0;
+                printf(" %8.2f\n", speedup);
+
+                if (no_of_results < MAX_RESULTS) {
+                    BenchResult *result = &results[no_of_results++];
+                    snprintf(result->name, sizeof(result->name), "%s/%s", bench->name, algorithm_name(alg_type));
+                    result->speedup = speedup;
+                    for (i = 0; i < no_of_baseline; i++) {
+                        if (strcmp(baseline[i].name, result->name) == 0 && sim_time >= MIN_CHECKED_TIME &&
+                            tick_time >= MIN_CHECKED_TIME && speedup < baseline[i].speedup * (1 - tolerance)) {
+                            printf("REGRESSION %s: event engine %.2fx the tick engine, baseline %.2fx\n",
+                                   result->name, speedup, baseline[i].speedup);
+                            regressions++;
+                        }
+                    }
+                }
+            }
+        }
+        free_workload(&workload);
+    }
+
+    if (write_baseline_file != NULL) {
+        FILE *f = fopen(write_baseline_file, "w");
+        if (f == NULL) {
+            printf("%s could not be written\n", write_baseline_file);
+        } else {
+            for (i = 0; i < no_of_results; i++) {
+                fprintf(f, "%s,%.2f\n", results[i].name, results[i].speedup);
+            }
+            fclose(f);
+        }
+    }
+
+    fclose(null_out);
+    unlink(file_name);
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+/**
+ * Sort Micro-benchmark
+ *
+ * Times sort_process_list and sort_process_list_by_id against the bubble
+ * sorts they replaced, on dense keys (counting sort path) and sparse keys
+ * (merge sort path), and checks every result against qsort.
+ *
+ * build: make sort_bench
+ * run:   ./sort_bench [max_processes]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../process.h"
+
+// the bubble sort is quadratic, it is only timed up to this many processes
+#define MAX_BUBBLE_COUNT 20000
+
+static void bubble_sort_process_list(Process** process_list, int no_of_processes) {
+    int count = 0;
+    int swapped = 1;
+    Process* temp;
+    int sorted = 0;
+
+    while(swapped == 1)
+    {
+        swapped = 0;
+
+        for(count = sorted; count < no_of_processes - sorted - 1; count++) {
+            if (process_list[count]->arrival_time > process_list[count + 1]->arrival_time) {
+                temp = process_list[count];
+                process_list[count] = process_list[count + 1];
+                process_list[count + 1] = temp;
+                swapped = 1;
+            }
+
+            if (process_list[count]->arrival_time == process_list[count + 1]->arrival_time &&
+                process_list[count]->process_id > process_list[count + 1]->process_id) {
+                temp = process_list[count];
+                process_list[count] = process_list[count + 1];
+                process_list[count + 1] = temp;
+                swapped = 1;
+            }
+        }
+        sorted++;
+    }
+}
+
+static void bubble_sort_process_list_by_id(Process** process_list, int no_of_processes) {
+    int count = 0;
+    int swapped = 1;
+    Process* temp;
+    int sorted = 0;
+
+    while(swapped == 1)
+    {
+        swapped = 0;
+
+        for(count = sorted; count < no_of_processes - sorted - 1; count++) {
+            if (process_list[count]->process_id > process_list[count + 1]->process_id) {
+                temp = process_list[count];
+                process_list[count] = process_list[count + 1];
+                process_list[count + 1] = temp;
+                swapped = 1;
+            }
+        }
+        sorted++;
+    }
+}
+
+static int qsort_arrival_then_id(const void *a, const void *b) {
+    Process *x = *(Process**) a, *y = *(Process**) b;
+    if (x->arrival_time != y->arrival_time) {
+        return x->arrival_time < y->arrival_time ? -1 : 1;
+    }
+    return x->process_id < y->process_id ? -1 : x->process_id > y->process_id;
+}
+
+static int qsort_id(const void *a, const void *b) {
+    Process *x = *(Process**) a, *y = *(Process**) b;
+    return x->process_id < y->process_id ? -1 : x->process_id > y->process_id;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fill(Process *processes, Process **list, int no_of_processes, int dense) {
+    int i, j;
+    Process *temp;
+    for (i = 0; i < no_of_processes; i++) {
+        processes[i].process_id = dense ? i : rand() * 4096 + i;
+        processes[i].arrival_time = dense ? rand() % (no_of_processes / 2 + 1) : rand();
+        list[i] = &processes[i];
+    }
+    // shuffle so the ids are not in order either
+    for (i = no_of_processes - 1; i > 0; i--) {
+        j = rand() % (i + 1);
+        temp = list[i];
+        list[i] = list[j];
+        list[j] = temp;
+    }
+}
+
+static void run(const char *name, void (*sort)(Process**, int), Process **input, Process **work,
+                Process **expected, int no_of_processes) {
+    double start, elapsed;
+    int ok;
+    memcpy(work, input, sizeof(Process*) * no_of_processes);
+    start = now();
+    sort(work, no_of_processes);
+    elapsed = now() - start;
+    ok = memcmp(work, expected, sizeof(Process*) * no_of_processes) == 0;
+    printf("  %-30s %12.6f s %14.0f processes/s  %s\n", name, elapsed,
+           elapsed > 0 ? no_of_processes / elapsed : 0, ok ? "ok" : "WRONG ORDER");
+}
+
+int main(int argc, char* argv[]) {
+    int max_processes = argc > 1 ? atoi(argv[1]) : 1000000;
+    int no_of_processes, dense;
+    Process *processes = malloc(sizeof(Process) * max_processes);
+    Process **input = malloc(sizeof(Process*) * max_processes);
+    Process **work = malloc(sizeof(Process*) * max_processes);
+    Process **expected = malloc(sizeof(Process*) * max_processes);
+
+    srand(42);
+    for (no_of_processes = 1000; no_of_processes <= max_processes; no_of_processes *= 10) {
+        for (dense = 1; dense >= 0; dense--) {
+            printf("%d processes, %s keys\n", no_of_processes, dense ? "dense" : "sparse");
+            fill(processes, input, no_of_processes, dense);
+
+            memcpy(expected, input, sizeof(Process*) * no_of_processes);
+            qsort(expected, no_of_processes, sizeof(Process*), qsort_arrival_then_id);
+            run("sort_process_list", sort_process_list, input, work, expected, no_of_processes);
+            if (no_of_processes <= MAX_BUBBLE_COUNT) {
+                run("bubble sort_process_list", bubble_sort_process_list, input, work, expected, no_of_processes);
+            }
+
+            memcpy(expected, input, sizeof(Process*) * no_of_processes);
+            qsort(expected, no_of_processes, sizeof(Process*), qsort_id);
+            run("sort_process_list_by_id", sort_process_list_by_id, input, work, expected, no_of_processes);
+            if (no_of_processes <= MAX_BUBBLE_COUNT) {
+                run("bubble sort_process_list_by_id", bubble_sort_process_list_by_id, input, work, expected,
+                    no_of_processes);
+            }
+        }
+    }
+
+    free(expected);
+    free(work);
+    free(input);
+    free(processes);
+    return 0;
+}
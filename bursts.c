@@ -0,0 +1,89 @@
+/**
+ * Burst Lists
+ *
+ * The table is only ever appended to while a workload is read and only ever
+ * read after, each process decoding its next bursts as it reaches them, so
+ * contexts made from the same workload share one table.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include "bursts.h"
+#include "instrument.h"
+
+#define INITIAL_CAPACITY 4096
+#define VARINT_MAX_BYTES 5
+
+/**
+ * Appends burst, coded against previous, the burst of the same kind before it
+ * returns 1, or 0 if the table can't grow
+ */
+int append_burst(BurstTable *table, int previous, int burst) {
+    // the difference wraps around in unsigned, so any two ints code and decode exactly
+    unsigned int delta = (unsigned int) burst - (unsigned int) previous;
+    unsigned int zigzag = (delta << 1) ^ (0u - (delta >> 31));
+    if (table->capacity - table->length < VARINT_MAX_BYTES) {
+        size_t capacity = table->capacity == 0 ? INITIAL_CAPACITY : table->capacity * 2;
+        // processes keep their offset into the table in an int
+        if (capacity > INT_MAX) {
+            return 0;
+        }
+        unsigned char *bytes = realloc(table->bytes, capacity);
+        INSTRUMENT_COUNT(allocations);
+        if (bytes == NULL) {
+            return 0;
+        }
+        table->bytes = bytes;
+        table->capacity = capacity;
+    }
+    while (zigzag >= 0x80) {
+        table->bytes[table->length++] = (unsigned char) (zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    table->bytes[table->length++] = (unsigned char) zigzag;
+    return 1;
+}
+
+void free_burst_table(BurstTable *table) {
+    free(table->bytes);
+    table->bytes = NULL;
+    table->length = table->capacity = 0;
+}
+
+// the next burst of the process's list, of the same kind as previous
+static int take_burst(const unsigned char *bursts, Process *process, int previous) {
+    unsigned int zigzag = 0, delta;
+    int shift = 0;
+    unsigned char byte;
+    process->bursts_taken++;
+    // cpu, io, cpu processes have no list, their last burst is their first one again
+    if (process->burst_offset < 0) {
+        return previous;
+    }
+    do {
+        byte = bursts[process->next_burst++];
+        zigzag |= (unsigned int) (byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+    return (int) ((unsigned int) previous + delta);
+}
+
+/**
+ * Moves a process that just finished a cpu burst on to its next one: io_time
+ * becomes the io burst in between, with none of it spent, and cpu_time the
+ * cpu burst after it
+ * returns 1, or 0 if the burst it finished was its last
+ */
+int advance_burst(const unsigned char *bursts, Process *process) {
+    if (process->bursts_taken == process->burst_count) {
+        return 0;
+    }
+    // the io after the first cpu burst is already in io_time
+    if (process->bursts_taken > 0) {
+        process->io_time = take_burst(bursts, process, process->io_time);
+        process->spent_io_time = 0;
+    }
+    process->cpu_time = take_burst(bursts, process, process->cpu_time);
+    return 1;
+}
@@ -0,0 +1,27 @@
+/**
+ * Burst Lists
+ */
+
+#ifndef SCHEDULERS_BURSTS_H
+#define SCHEDULERS_BURSTS_H
+#include <stddef.h>
+#include "process.h"
+
+/* The bursts of every process with a burst list, one list after the other.
+ * A process keeps its first cpu and io burst in cpu_time and io_time like any
+ * other, the table holds the rest of its list: the next cpu burst, the io burst
+ * after it and so on, ending with a cpu burst. Each burst is stored as the
+ * difference to the one before it of the same kind, zigzag coded in a varint,
+ * so bursts that hardly change take a byte each.
+ */
+typedef struct BurstTable {
+    unsigned char *bytes;
+    size_t length;
+    size_t capacity;
+} BurstTable;
+
+int append_burst(BurstTable *table, int previous, int burst);
+void free_burst_table(BurstTable *table);
+int advance_burst(const unsigned char *bursts, Process *process);
+
+#endif //SCHEDULERS_BURSTS_H
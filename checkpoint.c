@@ -0,0 +1,332 @@
+/**
+ * Simulation Checkpoints
+ *
+ * Saves rrr's state between two ticks and puts it back, so a long replay can
+ * go on from its last checkpoint, or be branched from one, with the same
+ * results it would have had running straight through. A checkpoint is
+ * written to a temporary file that is renamed over the last one, a run
+ * stopped halfway through writing it still has the one before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "checkpoint.h"
+
+#define HEADER_SIZE 72
+#define BLOCKED_ENTRY_SIZE 16
+#define PROCESS_RECORD_WORDS 12
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+// a checkpoint as it is written or read, words are appended or taken at the cursor
+typedef struct CheckpointBuffer {
+    unsigned char *bytes;
+    size_t size;
+    size_t cursor;
+} CheckpointBuffer;
+
+static uint64_t fnv1a(const unsigned char *bytes, size_t size, uint64_t hash) {
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static void put_u32(CheckpointBuffer *b, uint32_t value) {
+    unsigned char *bytes = b->bytes + b->cursor;
+    bytes[0] = value & 0xff;
+    bytes[1] = (value >> 8) & 0xff;
+    bytes[2] = (value >> 16) & 0xff;
+    bytes[3] = (value >> 24) & 0xff;
+    b->cursor += 4;
+}
+
+static void put_u64(CheckpointBuffer *b, uint64_t value) {
+    put_u32(b, (uint32_t) value);
+    put_u32(b, (uint32_t) (value >> 32));
+}
+
+static uint32_t get_u32(CheckpointBuffer *b) {
+    const unsigned char *bytes = b->bytes + b->cursor;
+    b->cursor += 4;
+    return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+static uint64_t get_u64(CheckpointBuffer *b) {
+    uint64_t low = get_u32(b);
+    return low | (uint64_t) get_u32(b) << 32;
+}
+
+// the slot of a process of the context, -1 for NULL
+static int slot_of(SchedulerContext *context, Process *process) {
+    return process == NULL ? -1 : (int) (process - context->processes);
+}
+
+// the process of a slot read back, NULL for -1, or invalid if it is out of range
+static int process_at(SchedulerContext *context, int slot, Process **process) {
+    if (slot == -1) {
+        *process = NULL;
+        return 1;
+    }
+    if (slot < 0 || slot >= context->no_of_processes) {
+        return 0;
+    }
+    *process = &context->processes[slot];
+    return 1;
+}
+
+/**
+ * returns the fingerprint of the parts of the processes that stay the same
+ * throughout a run, for telling whether a checkpoint is of this workload
+ */
+static uint64_t workload_fingerprint(SchedulerContext *context) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    unsigned char bytes[24];
+    CheckpointBuffer b = {bytes, sizeof(bytes), 0};
+    int i;
+    for (i = 0; i < context->no_of_processes; i++) {
+        Process *process = context->process_list[i];
+        b.cursor = 0;
+        put_u32(&b, (uint32_t) process->process_id);
+        put_u32(&b, (uint32_t) process->arrival_time);
+        put_u32(&b, (uint32_t) process->priority);
+        put_u32(&b, (uint32_t) process->burst_offset);
+        put_u32(&b, (uint32_t) process->burst_count);
+        put_u32(&b, (uint32_t) process->work);
+        hash = fnv1a(bytes, sizeof(bytes), hash);
+    }
+    return hash;
+}
+
+/**
+ * Writes the state of the run to file_name, through a temporary file next to it
+ * returns CHECKPOINT_OK, CHECKPOINT_NO_MEMORY, or CHECKPOINT_NOT_FOUND if it
+ * can't be written
+ */
+int save_rr_checkpoint(SchedulerContext *context, RrState *state, const char *file_name) {
+    ArrivalIndex *arrivals = state->arrivals;
+    ProcessQueue *queue = state->queue;
+    BlockedSet *blocked = state->blocked;
+    CheckpointBuffer b;
+    char *temporary;
+    FILE *f;
+    int i, ok;
+
+    b.size = HEADER_SIZE + (size_t) queue->count * 4 + (size_t) blocked->count * BLOCKED_ENTRY_SIZE +
+             (size_t) arrivals->next * PROCESS_RECORD_WORDS * 4 + 8;
+    b.bytes = malloc(b.size);
+    temporary = malloc(strlen(file_name) + 5);
+    INSTRUMENT_ADD(allocations, 2);
+    if (b.bytes == NULL || temporary == NULL) {
+        free(b.bytes);
+        free(temporary);
+        return CHECKPOINT_NO_MEMORY;
+    }
+    b.cursor = 0;
+
+    memcpy(b.bytes, CHECKPOINT_MAGIC, 8);
+    b.cursor = 8;
+    put_u32(&b, CHECKPOINT_VERSION);
+    put_u32(&b, (uint32_t) context->quantum);
+    put_u32(&b, (uint32_t) context->no_of_processes);
+    put_u32(&b, 0);
+    put_u64(&b, workload_fingerprint(context));
+    put_u32(&b, (uint32_t) state->tick);
+    put_u32(&b, (uint32_t) state->idle_count);
+    put_u32(&b, (uint32_t) state->run_time);
+    put_u32(&b, (uint32_t) state->finished_count);
+    put_u32(&b, (uint32_t) slot_of(context, state->running));
+    put_u32(&b, (uint32_t) arrivals->next);
+    put_u32(&b, (uint32_t) queue->count);
+    put_u32(&b, (uint32_t) blocked->count);
+    put_u64(&b, (uint64_t) blocked->next_seq);
+
+    for (i = 0; i < queue->count; i++) {
+        put_u32(&b, (uint32_t) slot_of(context, queue->slots[(queue->head + i) % queue->capacity]));
+    }
+    for (i = 0; i < blocked->count; i++) {
+        put_u32(&b, (uint32_t) blocked->heap[i].deadline);
+        put_u64(&b, (uint64_t) blocked->heap[i].seq);
+        put_u32(&b, (uint32_t) slot_of(context, blocked->heap[i].process));
+    }
+    for (i = 0; i < arrivals->next; i++) {
+        Process *process = arrivals->order[i];
+        int slot = slot_of(context, process);
+        put_u32(&b, (uint32_t) slot);
+        put_u32(&b, (uint32_t) process->status);
+        put_u32(&b, (uint32_t) process->spent_cpu_time);
+        put_u32(&b, (uint32_t) process->spent_io_time);
+        put_u32(&b, (uint32_t) process->turnaround);
+        put_u32(&b, (uint32_t) process->executionStatus);
+        put_u32(&b, (uint32_t) process->io_deadline);
+        put_u32(&b, (uint32_t) process->cpu_time);
+        put_u32(&b, (uint32_t) process->io_time);
+        put_u32(&b, (uint32_t) process->next_burst);
+        put_u32(&b, (uint32_t) process->bursts_taken);
+        put_u32(&b, (uint32_t) context->first_run[slot]);
+    }
+    put_u64(&b, fnv1a(b.bytes, b.cursor, FNV_OFFSET_BASIS));
+
+    strcpy(temporary, file_name);
+    strcat(temporary, ".tmp");
+    f = fopen(temporary, "wb");
+    ok = f != NULL && fwrite(b.bytes, 1, b.size, f) == b.size;
+    if (f != NULL && fclose(f) != 0) {
+        ok = 0;
+    }
+    ok = ok && rename(temporary, file_name) == 0;
+    if (!ok) {
+        fprintf(stderr, "Checkpoint %s could not be written\n", file_name);
+        remove(temporary);
+    }
+    free(temporary);
+    free(b.bytes);
+    return ok ? CHECKPOINT_OK : CHECKPOINT_NOT_FOUND;
+}
+
+static int read_file(const char *file_name, CheckpointBuffer *b) {
+    FILE *f = fopen(file_name, "rb");
+    long size;
+    if (f == NULL) {
+        return CHECKPOINT_NOT_FOUND;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+        fclose(f);
+        return CHECKPOINT_NOT_FOUND;
+    }
+    b->size = (size_t) size;
+    b->cursor = 0;
+    b->bytes = malloc(b->size + 1);
+    INSTRUMENT_COUNT(allocations);
+    if (b->bytes == NULL) {
+        fclose(f);
+        return CHECKPOINT_NO_MEMORY;
+    }
+    if (fread(b->bytes, 1, b->size, f) != b->size) {
+        free(b->bytes);
+        fclose(f);
+        return CHECKPOINT_NOT_FOUND;
+    }
+    fclose(f);
+    return CHECKPOINT_OK;
+}
+
+/**
+ * Checks the checkpoint in b and puts its state into the context and state,
+ * whose queue, blocked set and arrival index are set up for the context's
+ * processes and still empty
+ */
+static int restore_state(SchedulerContext *context, RrState *state, CheckpointBuffer *b) {
+    int i, n = context->no_of_processes;
+    int arrived, queued, blocked_count, slot;
+    Process *process;
+
+    if (b->size < HEADER_SIZE + 8 || memcmp(b->bytes, CHECKPOINT_MAGIC, 8) != 0) {
+        return CHECKPOINT_MALFORMED;
+    }
+    b->cursor = b->size - 8;
+    if (fnv1a(b->bytes, b->size - 8, FNV_OFFSET_BASIS) != get_u64(b)) {
+        return CHECKPOINT_MALFORMED;
+    }
+    b->cursor = 8;
+    if (get_u32(b) != CHECKPOINT_VERSION) {
+        return CHECKPOINT_MALFORMED;
+    }
+    if ((int) get_u32(b) != context->quantum || (int) get_u32(b) != n) {
+        return CHECKPOINT_MISMATCH;
+    }
+    get_u32(b);
+    if (get_u64(b) != workload_fingerprint(context)) {
+        return CHECKPOINT_MISMATCH;
+    }
+    state->tick = (int) get_u32(b);
+    state->idle_count = (int) get_u32(b);
+    state->run_time = (int) get_u32(b);
+    state->finished_count = (int) get_u32(b);
+    if (!process_at(context, (int) get_u32(b), &state->running)) {
+        return CHECKPOINT_MALFORMED;
+    }
+    arrived = (int) get_u32(b);
+    queued = (int) get_u32(b);
+    blocked_count = (int) get_u32(b);
+    state->blocked->next_seq = (long) get_u64(b);
+    // rrr's queue has room for every process and the one it puts back
+    if (arrived < 0 || arrived > n || queued < 0 || queued > state->queue->capacity ||
+        blocked_count < 0 || blocked_count > n ||
+        b->size != HEADER_SIZE + (size_t) queued * 4 + (size_t) blocked_count * BLOCKED_ENTRY_SIZE +
+                   (size_t) arrived * PROCESS_RECORD_WORDS * 4 + 8) {
+        return CHECKPOINT_MALFORMED;
+    }
+
+    for (i = 0; i < queued; i++) {
+        if (!process_at(context, (int) get_u32(b), &process)) {
+            return CHECKPOINT_MALFORMED;
+        }
+        enque(state->queue, process);
+    }
+    if (blocked_count > state->blocked->capacity) {
+        BlockedEntry *heap = realloc(state->blocked->heap, sizeof(BlockedEntry) * blocked_count);
+        INSTRUMENT_COUNT(allocations);
+        if (heap == NULL) {
+            return CHECKPOINT_NO_MEMORY;
+        }
+        state->blocked->heap = heap;
+        state->blocked->capacity = blocked_count;
+    }
+    for (i = 0; i < blocked_count; i++) {
+        BlockedEntry *entry = &state->blocked->heap[i];
+        entry->deadline = (int) get_u32(b);
+        entry->seq = (long) get_u64(b);
+        if (!process_at(context, (int) get_u32(b), &entry->process) || entry->process == NULL) {
+            return CHECKPOINT_MALFORMED;
+        }
+    }
+    state->blocked->count = blocked_count;
+    state->arrivals->next = arrived;
+    for (i = 0; i < arrived; i++) {
+        slot = (int) get_u32(b);
+        process = state->arrivals->order[i];
+        // processes arrive in the same order on every run of the same workload
+        if (slot != slot_of(context, process)) {
+            return CHECKPOINT_MISMATCH;
+        }
+        process->status = (int) get_u32(b);
+        if (process->status < RUNNING || process->status > NONE) {
+            return CHECKPOINT_MALFORMED;
+        }
+        process->spent_cpu_time = (int) get_u32(b);
+        process->spent_io_time = (int) get_u32(b);
+        process->turnaround = (int) get_u32(b);
+        process->executionStatus = (int) get_u32(b);
+        process->io_deadline = (int) get_u32(b);
+        process->cpu_time = (int) get_u32(b);
+        process->io_time = (int) get_u32(b);
+        process->next_burst = (int) get_u32(b);
+        process->bursts_taken = (int) get_u32(b);
+        context->first_run[slot] = (int) get_u32(b);
+        context->status[slot] = process->status;
+    }
+    return CHECKPOINT_OK;
+}
+
+/**
+ * Puts the state saved in file_name into the context, whose processes are
+ * in their initial state, and into state, whose queue, blocked set and
+ * arrival index are set up for them and still empty
+ * returns CHECKPOINT_OK, or why the checkpoint can't be used, in which case
+ * the context and state are left half restored
+ */
+int restore_rr_checkpoint(SchedulerContext *context, RrState *state, const char *file_name) {
+    CheckpointBuffer b;
+    int result = read_file(file_name, &b);
+    if (result != CHECKPOINT_OK) {
+        return result;
+    }
+    result = restore_state(context, state, &b);
+    free(b.bytes);
+    return result;
+}
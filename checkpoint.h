@@ -0,0 +1,38 @@
+/**
+ * Simulation Checkpoints
+ */
+
+#ifndef SCHEDULERS_CHECKPOINT_H
+#define SCHEDULERS_CHECKPOINT_H
+#include "fcfs.h"
+
+enum CheckpointResult {CHECKPOINT_OK = 0, CHECKPOINT_NOT_FOUND = -1, CHECKPOINT_MALFORMED = -2,
+                       CHECKPOINT_MISMATCH = -3, CHECKPOINT_NO_MEMORY = -4};
+
+/* A checkpoint is rrr's state at the start of a tick, every field little endian:
+ *   0  magic "SCHEDCP\0"
+ *   8  u32 version
+ *  12  u32 quantum
+ *  16  u32 number of processes
+ *  20  u32 reserved, 0
+ *  24  u64 FNV-1a fingerprint of the processes' ids, arrivals, priorities and bursts
+ *  32  u32 tick, idle ticks, run time of the running process, finished processes,
+ *      slot of the running process, processes arrived, ready queue length,
+ *      blocked processes
+ *  64  u64 next blocked sequence number
+ * followed by the ready queue as slots from its head, the blocked set's heap
+ * as (u32 deadline, u64 sequence number, u32 slot), a record of every process
+ * that has arrived, in arrival order, and a u64 FNV-1a checksum of everything
+ * before it. A slot is an index into the process list, -1 standing for none.
+ * Processes yet to arrive are in their initial state and not written, so
+ * restoring takes as long as the state that is live, however late the tick.
+ */
+#define CHECKPOINT_MAGIC "SCHEDCP"
+#define CHECKPOINT_VERSION 1
+// ticks between two checkpoints unless --checkpoint-every says otherwise
+#define DEFAULT_CHECKPOINT_INTERVAL 1000000
+
+int save_rr_checkpoint(SchedulerContext *context, RrState *state, const char *file_name);
+int restore_rr_checkpoint(SchedulerContext *context, RrState *state, const char *file_name);
+
+#endif //SCHEDULERS_CHECKPOINT_H
@@ -0,0 +1,368 @@
+/**
+ * Event-driven Scheduler Simulation
+ *
+ * Runs FCFS on the tick steps of fcfs.c and RR on rrr's own step, but keeps
+ * the upcoming arrival, burst end and quantum expiry times in a min-heap, next
+ * to the blocked set holding the io completion times, and jumps the clock
+ * straight from one event to the next. Ticks in
+ * between only repeat the state printed at the last event, so they are handed
+ * to the timeline as repeats instead of being simulated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event.h"
+
+// returns 1, or 0 if there is not enough memory
+int event_queue_init(EventQueue *q, int capacity) {
+    if (capacity < 4) {
+        capacity = 4;
+    }
+    q->heap = malloc(sizeof(Event) * capacity);
+    INSTRUMENT_COUNT(allocations);
+    q->size = 0;
+    q->capacity = q->heap == NULL ? 0 : capacity;
+    q->next_seq = 0;
+    return q->heap != NULL;
+}
+
+void event_queue_free(EventQueue *q) {
+    free(q->heap);
+    q->heap = NULL;
+    q->size = q->capacity = 0;
+}
+
+static int event_before(Event *a, Event *b) {
+    if (a->time != b->time) {
+        return a->time < b->time;
+    }
+    return a->seq < b->seq;
+}
+
+void event_queue_push(EventQueue *q, int time, int type, Process *process, int generation) {
+    if (q->size == q->capacity) {
+        q->capacity *= 2;
+        q->heap = realloc(q->heap, sizeof(Event) * q->capacity);
+        INSTRUMENT_COUNT(allocations);
+    }
+    INSTRUMENT_COUNT(queue_ops);
+
+    Event event;
+    event.time = time;
+    event.type = type;
+    event.generation = generation;
+    event.seq = q->next_seq++;
+    event.process = process;
+
+    // sift up
+    int i = q->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!event_before(&event, &q->heap[parent])) {
+            break;
+        }
+        q->heap[i] = q->heap[parent];
+        i = parent;
+    }
+    q->heap[i] = event;
+}
+
+Event* event_queue_top(EventQueue *q) {
+    if (q->size == 0) {
+        return NULL;
+    }
+    return &q->heap[0];
+}
+
+void event_queue_pop(EventQueue *q) {
+    if (q->size == 0) {
+        return;
+    }
+
+    INSTRUMENT_COUNT(queue_ops);
+    Event last = q->heap[--q->size];
+    int i = 0;
+    // sift down
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= q->size) {
+            break;
+        }
+        if (child + 1 < q->size && event_before(&q->heap[child + 1], &q->heap[child])) {
+            child++;
+        }
+        if (!event_before(&q->heap[child], &last)) {
+            break;
+        }
+        q->heap[i] = q->heap[child];
+        i = child;
+    }
+    q->heap[i] = last;
+}
+
+/**
+ * Returns the time of the earliest live event, io completions included,
+ * dropping burst end and quantum events armed for a process that is no longer running
+ * returns -1 if there are no events left
+ */
+static int next_event_time(EventQueue *q, BlockedSet *blocked, int generation) {
+    Event *top;
+    int io = next_io_completion(blocked);
+    while ((top = event_queue_top(q)) != NULL) {
+        if ((top->type == BURST_END_EVENT || top->type == QUANTUM_EVENT) && top->generation != generation) {
+            event_queue_pop(q);
+            continue;
+        }
+        return io != -1 && io < top->time ? io : top->time;
+    }
+    return io;
+}
+
+int run_fcfs_events(SchedulerContext *context) {
+    Process **process_list = context->process_list;
+    int no_of_processes = context->no_of_processes;
+    Timeline timeline;
+    timeline_init(&timeline, context->out, FCFS_TIMELINE, context->timeline_mode, context->summary_format,
+                  process_list, context->status, no_of_processes);
+    timeline.writer = context->writer;
+    subscribe_timeline(context, &timeline);
+
+    // keep a queue of ready processes
+    ProcessQueue q;
+    int allocated = init_process_queue(&q, no_of_processes);
+
+    ArrivalIndex arrivals;
+    allocated &= build_arrival_index(&arrivals, process_list, no_of_processes);
+
+    // keep the IO Blocked processes ordered by the tick their io completes
+    BlockedSet blocked;
+    allocated &= init_blocked_set(&blocked, no_of_processes);
+
+    Process **to_be_enqued = malloc(sizeof(Process*) * (no_of_processes + 1));
+    int to_be_enqued_count;
+
+    // processes that finished their io this tick
+    Process **woken = malloc(sizeof(Process*) * (no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 2);
+    int woken_count;
+
+    Process *running = NULL;
+    int terminated_count = 0;
+    int tick = 0, not_utilized_count = 0;
+    int next;
+
+    // burst end events carry the generation they were armed in
+    int generation = 0, armed_end = -1;
+
+    EventQueue events;
+    allocated &= event_queue_init(&events, no_of_processes + 2);
+    int result = allocated && to_be_enqued != NULL && woken != NULL ? RUN_OK : RUN_NO_MEMORY;
+
+    if (result == RUN_OK && next_arrival_time(&arrivals) != -1) {
+        event_queue_push(&events, next_arrival_time(&arrivals), ARRIVAL_EVENT, NULL, 0);
+    }
+
+    Event *event;
+
+    while (result == RUN_OK && terminated_count != no_of_processes) {
+        context->now = tick;
+        to_be_enqued_count = 0;
+
+        // consume the events due at this tick
+        while ((event = event_queue_top(&events)) != NULL && event->time <= tick) {
+            event_queue_pop(&events);
+        }
+
+        if (next_arrival_time(&arrivals) == tick) {
+            to_be_enqued_count = admit_arrivals(context, &arrivals, to_be_enqued, tick);
+            if (next_arrival_time(&arrivals) != -1) {
+                event_queue_push(&events, next_arrival_time(&arrivals), ARRIVAL_EVENT, NULL, 0);
+            }
+        }
+        woken_count = wake_processes(context, &blocked, woken, tick);
+
+        if (running != NULL && advance_running(context, &blocked, running, tick) != BURST_GOES_ON) {
+            if (running->status == TERMINATED) {
+                terminated_count++;
+            }
+            running = NULL;
+        }
+        if (!enque_by_id(&q, to_be_enqued, to_be_enqued_count, woken, woken_count)) {
+            result = RUN_NO_MEMORY;
+            break;
+        }
+
+        // choose a process to run
+        INSTRUMENT_BEGIN(DISPATCH_TIMING);
+        if (running == NULL) {
+            running = deque(&q);
+            if (running != NULL) {
+                set_status(context, running, RUNNING);
+            } else {
+                not_utilized_count++;
+                report_idle(context);
+                INSTRUMENT_COUNT(idle_ticks);
+            }
+        }
+        INSTRUMENT_END(DISPATCH_TIMING);
+
+        // print processes info
+        timeline_tick(&timeline, tick);
+        tick++;
+
+        if (terminated_count == no_of_processes) {
+            break;
+        }
+
+        // arm the tick at which the running process ends its burst
+        next = -1;
+        if (running != NULL && running->cpu_time > running->spent_cpu_time) {
+            next = tick - 1 + running->cpu_time - running->spent_cpu_time;
+        }
+        if (next != armed_end) {
+            generation++;
+            armed_end = next;
+            if (next != -1) {
+                event_queue_push(&events, next, BURST_END_EVENT, running, generation);
+            }
+        }
+
+        // jump to the next event, the ticks in between look like this one
+        next = next_event_time(&events, &blocked, generation);
+        if (next == -1) {
+            // nothing left that could ever change the state
+            break;
+        }
+        if (next > tick) {
+            timeline_repeat(&timeline, tick, next);
+            if (running != NULL) {
+                running->spent_cpu_time += next - tick;
+            } else {
+                not_utilized_count += next - tick;
+                INSTRUMENT_ADD(idle_ticks, next - tick);
+            }
+            tick = next;
+        }
+    }
+    if (result == RUN_OK) {
+        report_results(context, &timeline, tick, not_utilized_count);
+    } else {
+        timeline_finish(&timeline);
+    }
+
+    event_queue_free(&events);
+    free_process_queue(&q);
+    free(to_be_enqued);
+    free(woken);
+    free_blocked_set(&blocked);
+    free_arrival_index(&arrivals);
+    return result;
+}
+
+int rrr_events(SchedulerContext *context) {
+    Process **process_list = context->process_list;
+    int no_of_processes = context->no_of_processes;
+    int quantum = context->quantum;
+    // a preempted process is put back before the next one leaves, hence the extra slot
+    ProcessQueue queue;
+    int allocated = init_process_queue(&queue, no_of_processes + 1);
+    BlockedSet ioQueue;
+    allocated &= init_blocked_set(&ioQueue, no_of_processes);
+    ArrivalIndex arrivals;
+    allocated &= build_arrival_index(&arrivals, process_list, no_of_processes);
+
+    Process **to_be_enqued = malloc(sizeof(Process*) * (no_of_processes + 1));
+    Process **io_done = malloc(sizeof(Process*) * (no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 2);
+
+    RrState state = {0, 0, 0, 0, NULL, &queue, &ioQueue, &arrivals, 0};
+    Timeline timeline;
+    timeline_init(&timeline, context->out, RR_TIMELINE, context->timeline_mode, context->summary_format,
+                  process_list, context->status, no_of_processes);
+    timeline.writer = context->writer;
+    subscribe_timeline(context, &timeline);
+
+    int generation = 0, armed_end = -1, armed_expiry = -1, armed_arrival = -1;
+    int next, end, expiry, stepped;
+    Process *running;
+
+    EventQueue events;
+    allocated &= event_queue_init(&events, no_of_processes + 2);
+    int result = allocated && to_be_enqued != NULL && io_done != NULL ? RUN_OK : RUN_NO_MEMORY;
+
+    Event *event;
+
+    while (result == RUN_OK && state.finished_count < no_of_processes) {
+        if (!state.retry) {
+            while ((event = event_queue_top(&events)) != NULL && event->time <= state.tick) {
+                event_queue_pop(&events);
+            }
+        }
+        // rrr's own step, only the ticks where nothing happens are skipped
+        stepped = rrr_step(context, &state, &timeline, to_be_enqued, io_done);
+        if (stepped < 0) {
+            result = RUN_NO_MEMORY;
+            break;
+        } else if (!stepped) {
+            continue;
+        }
+        if (next_arrival_time(&arrivals) != armed_arrival) {
+            armed_arrival = next_arrival_time(&arrivals);
+            if (armed_arrival != -1) {
+                event_queue_push(&events, armed_arrival, ARRIVAL_EVENT, NULL, 0);
+            }
+        }
+
+        // arm the burst end and quantum expiry of the running process
+        running = state.running;
+        if (running == NULL) {
+            end = expiry = -1;
+        } else {
+            next = running->cpu_time - running->spent_cpu_time + 1;
+            end = state.tick - 1 + (next > 1 ? next : 1);
+            next = quantum - state.run_time + 1;
+            expiry = state.tick - 1 + (next > 1 ? next : 1);
+        }
+        if (end != armed_end || expiry != armed_expiry) {
+            generation++;
+            armed_end = end;
+            armed_expiry = expiry;
+            if (end != -1) {
+                event_queue_push(&events, end, BURST_END_EVENT, running, generation);
+                event_queue_push(&events, expiry, QUANTUM_EVENT, running, generation);
+            }
+        }
+
+        // jump to the next event, the ticks in between look like this one
+        next = next_event_time(&events, &ioQueue, generation);
+        if (next == -1) {
+            // nothing left that could ever change the state
+            break;
+        }
+        if (next > state.tick) {
+            timeline_repeat(&timeline, state.tick, next);
+            if (running != NULL) {
+                running->spent_cpu_time += next - state.tick;
+                state.run_time += next - state.tick;
+            } else {
+                state.idle_count += next - state.tick;
+                INSTRUMENT_ADD(idle_ticks, next - state.tick);
+            }
+            state.tick = next;
+        }
+    }
+    if (result == RUN_OK) {
+        report_rr_results(context, &timeline, &state);
+    } else {
+        timeline_finish(&timeline);
+    }
+
+    event_queue_free(&events);
+    free_process_queue(&queue);
+    free_blocked_set(&ioQueue);
+    free(io_done);
+    free(to_be_enqued);
+    free_arrival_index(&arrivals);
+    return result;
+}
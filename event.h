@@ -0,0 +1,38 @@
+/**
+ * Event-driven Scheduler Simulation
+ */
+
+#ifndef SCHEDULERS_EVENT_H
+#define SCHEDULERS_EVENT_H
+#include "fcfs.h"
+
+// io completions are kept in the BlockedSet shared with the tick engines
+enum EventType {ARRIVAL_EVENT, BURST_END_EVENT, QUANTUM_EVENT};
+
+typedef struct Event {
+    int time;
+    int type;
+    int generation; // burst end and quantum events are dropped once the running process changes
+    long seq; // breaks ties between events of the same tick in insertion order
+    Process *process;
+} Event;
+
+// binary min-heap ordered by (time, seq)
+typedef struct EventQueue {
+    Event *heap;
+    int size;
+    int capacity;
+    long next_seq;
+} EventQueue;
+
+int event_queue_init(EventQueue *q, int capacity);
+void event_queue_free(EventQueue *q);
+void event_queue_push(EventQueue *q, int time, int type, Process *process, int generation);
+Event* event_queue_top(EventQueue *q);
+void event_queue_pop(EventQueue *q);
+
+int run_fcfs_events(SchedulerContext *context);
+
+int rrr_events(SchedulerContext *context);
+
+#endif //SCHEDULERS_EVENT_H
@@ -4,101 +4,290 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include "fcfs.h"
+#include "bursts.h"
+#include "checkpoint.h"
 
-#define DEBUG_MODE 1
+/**
+ * Sets up an empty queue able to hold capacity processes, the schedulers size
+ * it so enque and deque never allocate while the simulation runs
+ * returns 1, or 0 if there is not enough memory
+ */
+int init_process_queue(ProcessQueue *q, int capacity) {
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    q->slots = malloc(sizeof(Process*) * capacity);
+    INSTRUMENT_COUNT(allocations);
+    q->capacity = q->slots == NULL ? 0 : capacity;
+    q->head = 0;
+    q->count = 0;
+    return q->slots != NULL;
+}
 
-void enque(ProcessQueue *q, Process *process) {
+void free_process_queue(ProcessQueue *q) {
+    free(q->slots);
+    q->slots = NULL;
+    q->capacity = q->head = q->count = 0;
+}
+
+/**
+ * Puts a process at the tail of the queue
+ * returns 1, or 0 if the queue is full and there is not enough memory to
+ * grow it, the process then left out
+ */
+int enque(ProcessQueue *q, Process *process) {
     if (q == NULL) {
         fprintf(stderr, "Queue is Null");
-        return;
+        return 0;
     }
     
-    ProcessQueueNode *processQueueNode = malloc(sizeof(ProcessQueueNode));
-    processQueueNode->process = process;
+    // only reached if a queue was sized too small, unwrap it into a larger buffer
+    if (q->count == q->capacity) {
+        Process **slots = malloc(sizeof(Process*) * (q->capacity > 0 ? q->capacity * 2 : 1));
+        INSTRUMENT_COUNT(allocations);
+        int i;
+        if (slots == NULL) {
+            return 0;
+        }
+        for (i = 0; i < q->count; i++) {
+            slots[i] = q->slots[(q->head + i) % q->capacity];
+        }
+        free(q->slots);
+        q->slots = slots;
+        q->capacity = q->capacity > 0 ? q->capacity * 2 : 1;
+        q->head = 0;
+    }
     
-    processQueueNode->next = NULL;
-    // if queue is empty
-    if (q->head == NULL) {
-        q->head = processQueueNode;
-        q->tail = processQueueNode;
-    } else {
-        q->tail->next = processQueueNode;
-        q->tail = processQueueNode;
+    int tail = q->head + q->count;
+    if (tail >= q->capacity) {
+        tail -= q->capacity;
     }
+    q->slots[tail] = process;
+    q->count++;
+    INSTRUMENT_COUNT(queue_ops);
+    return 1;
 }
 
 Process* deque(ProcessQueue *q) {
-    if (q->head == NULL) {
+    if (q->count == 0) {
         return NULL;
     }
     
-    Process* temp = q->head->process;
-    ProcessQueueNode* temp_node = q->head;
-    
-    if (q->head == q->tail) {
-        q->head = q->tail = NULL;
-    } else {
-        q->head = q->head->next;
+    Process* temp = q->slots[q->head];
+    if (++q->head == q->capacity) {
+        q->head = 0;
     }
-    
-    free(temp_node);
-    
-    if (DEBUG_MODE) {
-        ProcessQueueNode *ptr = q->head;
-        while(ptr != NULL) {
-//            printf("DEBUG: FCFS: QUEUE AFTER DEQUE: node id %d \n", ptr->process->process_id);
-            ptr = ptr->next;
-        }
-    }
-    
+    q->count--;
+    INSTRUMENT_COUNT(queue_ops);
     return temp;
 }
 
 Process* peak(ProcessQueue *q) {
-    return q->head->process;
+    if (q->count == 0) {
+        return NULL;
+    }
+    return q->slots[q->head];
 }
 
-void build_process_queue(ProcessQueue *q, Process **process_list) {
-    Process *ptr = *process_list;
-    int count = 0;
-    while (ptr != NULL) {
-        enque(q, ptr);
-        ptr = process_list[++count];
+/**
+ * Sets up an empty blocked set able to hold capacity processes
+ * returns 1, or 0 if there is not enough memory
+ */
+int init_blocked_set(BlockedSet *blocked, int capacity) {
+    if (capacity < 1) {
+        capacity = 1;
     }
-    
-    if (DEBUG_MODE) {
-        ProcessQueueNode *ptr = q->head;
-        while(ptr != NULL) {
-//            printf("DEBUG: FCFS: ENQUEUE: node id %d \n", ptr->process->process_id);
-            ptr = ptr->next;
+    blocked->heap = malloc(sizeof(BlockedEntry) * capacity);
+    INSTRUMENT_COUNT(allocations);
+    blocked->capacity = blocked->heap == NULL ? 0 : capacity;
+    blocked->count = 0;
+    blocked->next_seq = 0;
+    return blocked->heap != NULL;
+}
+
+void free_blocked_set(BlockedSet *blocked) {
+    free(blocked->heap);
+    blocked->heap = NULL;
+    blocked->capacity = blocked->count = 0;
+}
+
+static int blocked_before(BlockedEntry *a, BlockedEntry *b) {
+    if (a->deadline != b->deadline) {
+        return a->deadline < b->deadline;
+    }
+    return a->seq < b->seq;
+}
+
+/**
+ * Adds a process to the blocked set until the tick its io completes
+ */
+void block_process(BlockedSet *blocked, Process *process, int deadline) {
+    if (blocked->count == blocked->capacity) {
+        blocked->capacity *= 2;
+        blocked->heap = realloc(blocked->heap, sizeof(BlockedEntry) * blocked->capacity);
+        INSTRUMENT_COUNT(allocations);
+    }
+    INSTRUMENT_COUNT(queue_ops);
+
+    BlockedEntry entry;
+    entry.deadline = deadline;
+    entry.seq = blocked->next_seq++;
+    entry.process = process;
+    process->io_deadline = deadline;
+
+    // sift up
+    int i = blocked->count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!blocked_before(&entry, &blocked->heap[parent])) {
+            break;
         }
+        blocked->heap[i] = blocked->heap[parent];
+        i = parent;
     }
+    blocked->heap[i] = entry;
 }
 
 /**
- * Iterates over the process list and build a list of processes that
- * arrived to the system at this tick
- * returns that count of those processes
+ * returns the tick of the earliest io completion or -1 if nothing is blocked
+ */
+int next_io_completion(BlockedSet *blocked) {
+    if (blocked->count == 0) {
+        return -1;
+    }
+    return blocked->heap[0].deadline;
+}
+
+/**
+ * Takes the processes whose io completes by this tick out of the blocked set,
+ * in the order they were blocked when several complete together
+ * returns the count of those processes
+ */
+int get_io_completed_processes(Process **completed, BlockedSet *blocked, int tick) {
+    INSTRUMENT_BEGIN(IO_TIMING);
+    int completed_count = 0;
+    while (blocked->count > 0 && blocked->heap[0].deadline <= tick) {
+        completed[completed_count++] = blocked->heap[0].process;
+
+        // move the last entry to the root and sift it down
+        BlockedEntry last = blocked->heap[--blocked->count];
+        int i = 0;
+        while (1) {
+            int child = 2 * i + 1;
+            if (child >= blocked->count) {
+                break;
+            }
+            if (child + 1 < blocked->count && blocked_before(&blocked->heap[child + 1], &blocked->heap[child])) {
+                child++;
+            }
+            if (!blocked_before(&blocked->heap[child], &last)) {
+                break;
+            }
+            blocked->heap[i] = blocked->heap[child];
+            i = child;
+        }
+        blocked->heap[i] = last;
+    }
+    completed[completed_count] = NULL;
+    INSTRUMENT_ADD(queue_ops, completed_count);
+    INSTRUMENT_ADD(io_completions, completed_count);
+    INSTRUMENT_END(IO_TIMING);
+    return completed_count;
+}
+
+/**
+ * Enques two lists of processes that are each ordered by process id,
+ * merging them so the queue receives all of them in process id order
+ * returns 1, or 0 if the queue could not grow to take all of them
  */
-int get_arrived_processes(Process** arrived, Process** process_list, int tick) {
-    Process *ptr = *process_list;
-    int count = 0, arrived_count = 0;
-    while (ptr != NULL) {
-        if (ptr->arrival_time == tick) {
-            ptr->status = READY;
-            ptr->turnaround = tick;
-            arrived[arrived_count] = ptr;
-            arrived_count++;
+int enque_by_id(ProcessQueue *q, Process **first, int first_count, Process **second, int second_count) {
+    int i = 0, j = 0, queued = 1;
+    while (i < first_count && j < second_count) {
+        if (second[j]->process_id < first[i]->process_id) {
+            queued &= enque(q, second[j++]);
+        } else {
+            queued &= enque(q, first[i++]);
         }
-        ptr = process_list[++count];
+    }
+    while (i < first_count) {
+        queued &= enque(q, first[i++]);
+    }
+    while (j < second_count) {
+        queued &= enque(q, second[j++]);
+    }
+    return queued;
+}
+
+/**
+ * Builds the arrival index of a process list once before the simulation,
+ * so each tick only looks at the processes arriving at it
+ * returns 1, or 0 if there is not enough memory
+ */
+int build_arrival_index(ArrivalIndex *index, Process **process_list, int no_of_processes) {
+    index->order = malloc(sizeof(Process*) * (no_of_processes + 1));
+    INSTRUMENT_COUNT(allocations);
+    index->count = index->next = 0;
+    if (index->order == NULL) {
+        return 0;
+    }
+    memcpy(index->order, process_list, sizeof(Process*) * no_of_processes);
+    index->order[no_of_processes] = NULL;
+    index->count = no_of_processes;
+    index->next = 0;
+    // already in order when main sorted the process list, which costs one pass
+    sort_process_list(index->order, no_of_processes);
+    return 1;
+}
+
+void free_arrival_index(ArrivalIndex *index) {
+    free(index->order);
+    index->order = NULL;
+    index->count = index->next = 0;
+}
+
+/**
+ * returns the arrival time of the next process to arrive or -1 if all arrived
+ */
+int next_arrival_time(ArrivalIndex *index) {
+    // processes arriving before tick 0 never arrive
+    while (index->next < index->count && index->order[index->next]->arrival_time < 0) {
+        index->next++;
+    }
+    if (index->next == index->count) {
+        return -1;
+    }
+    return index->order[index->next]->arrival_time;
+}
+
+/**
+ * Advances the arrival index and builds a list of processes that
+ * arrived to the system at this tick, ordered by process id, the caller
+ * makes them ready
+ * returns that count of those processes
+ */
+int get_arrived_processes(Process** arrived, ArrivalIndex *index, int tick) {
+    INSTRUMENT_BEGIN(ARRIVAL_TIMING);
+    Process *ptr;
+    int arrived_count = 0;
+    while (index->next < index->count && index->order[index->next]->arrival_time < tick) {
+        index->next++;
+    }
+    while (index->next < index->count && index->order[index->next]->arrival_time == tick) {
+        ptr = index->order[index->next++];
+        ptr->turnaround = tick;
+        arrived[arrived_count] = ptr;
+        arrived_count++;
     }
     arrived[arrived_count] = NULL;
+    INSTRUMENT_END(ARRIVAL_TIMING);
     return arrived_count;
 }
 
 Process* choose_running_process(ProcessQueue* q, int tick) {
-    if (q->head == NULL) {
+    if (q->count == 0) {
         return NULL;
     }
     
@@ -113,323 +302,455 @@ Process* choose_running_process(ProcessQueue* q, int tick) {
     return NULL;
 }
 
-int run_fcfs(Process **process_list, int no_of_processes) {
-    // open file to keep output
-    FILE* f = fopen("FCFS.out", "w");
-    
-    // keep a queue of ready processes
-    ProcessQueue q;
-    q.head = q.tail = NULL;
-    
-    // keep a list of IO Blocked processes
-    Process** blocked_processes = malloc(sizeof(Process) * (no_of_processes - 1));
-    int blocked_count = 0;
-    
-    // keep track of running process
-    Process* running = NULL;
-    
-    // keeps track of terminated no of processes
-    int terminated_count = 0;
-    
-    int i;
-    Process* temp;
-    
-    // start cpu ticking
-    int tick = 0, not_utilized_count = 0;
-    
-    Process** to_be_enqued = malloc(sizeof(Process) * (no_of_processes - 1));
-    int to_be_enqued_count = 0;
-    
-    // while there's a process either in ready queue or blocked queue
-    while(terminated_count != no_of_processes) {
-        for (i = 0; i < to_be_enqued_count; i++)
-            to_be_enqued[i] = NULL;
-        to_be_enqued_count = 0;
-        
-        // get processes that arrived to the system
-        to_be_enqued_count += get_arrived_processes(to_be_enqued, process_list, tick);
-        if (DEBUG_MODE) {
-            printf("DEBUG: tick %d - %d arrived \n", tick, to_be_enqued_count);
+/**
+ * Takes in the processes that arrive at tick, READY and ordered by process id
+ * returns how many of them there are in arrived
+ */
+int admit_arrivals(SchedulerContext *context, ArrivalIndex *arrivals, Process **arrived, int tick) {
+    int count = get_arrived_processes(arrived, arrivals, tick), i;
+    for (i = 0; i < count; i++) {
+        set_status(context, arrived[i], READY);
+    }
+    return count;
+}
+
+/**
+ * Takes the blocked processes whose io completes at tick, READY with all of
+ * their io spent and ordered by process id to go in with the arrivals
+ * returns how many of them there are in woken
+ */
+int wake_processes(SchedulerContext *context, BlockedSet *blocked, Process **woken, int tick) {
+    int count = get_io_completed_processes(woken, blocked, tick), i;
+    for (i = 0; i < count; i++) {
+        woken[i]->spent_io_time = woken[i]->io_time;
+        set_status(context, woken[i], READY);
+    }
+    sort_process_list_by_id(woken, count);
+    return count;
+}
+
+/**
+ * Counts a tick of cpu time for the process, which moves on to its next burst
+ * once it has run all of the current one
+ * returns BURST_TERMINATES if that was its last cpu burst, BURST_BLOCKS if an
+ * io burst follows and BURST_GOES_ON if it keeps the cpu
+ */
+int run_burst_tick(const unsigned char *bursts, Process *process) {
+    if (++process->spent_cpu_time != process->cpu_time) {
+        return BURST_GOES_ON;
+    }
+    if (!advance_burst(bursts, process)) {
+        return BURST_TERMINATES;
+    }
+    process->spent_cpu_time = 0;
+    return process->io_time != 0 ? BURST_BLOCKS : BURST_GOES_ON;
+}
+
+/**
+ * Blocks a process that just finished a cpu burst at tick until its io is
+ * spent, counting up from the next tick, an io time it already spent never
+ * completes
+ */
+void wait_for_io(BlockedSet *blocked, Process *process, int tick) {
+    if (process->io_time > process->spent_io_time) {
+        block_process(blocked, process, tick + process->io_time - process->spent_io_time);
+    }
+}
+
+// its turnaround counts from the tick it arrived at, kept in turnaround until now
+void terminate_process(SchedulerContext *context, Process *process, int tick) {
+    set_status(context, process, TERMINATED);
+    process->turnaround = tick - process->turnaround;
+}
+
+/**
+ * The running process's tick on one cpu, it terminates or blocks at the end
+ * of its bursts
+ * returns what the tick did to it, see run_burst_tick
+ */
+int advance_running(SchedulerContext *context, BlockedSet *blocked, Process *running, int tick) {
+    int step = run_burst_tick(context->bursts, running);
+    if (step == BURST_TERMINATES) {
+        terminate_process(context, running, tick);
+    } else if (step == BURST_BLOCKS) {
+        set_status(context, running, BLOCKING);
+        wait_for_io(blocked, running, tick);
+    }
+    return step;
+}
+
+
+/**
+ * rrr counts a blocked process's spent io time up once per tick starting
+ * the tick after it blocks, until it reaches its io time
+ * returns the tick at which that happens
+ */
+static int rr_io_deadline(Process *process, int tick) {
+    int remaining = process->io_time - process->spent_io_time;
+    return tick + (remaining > 1 ? remaining : 1);
+}
+
+/**
+ * rrr leaves a preempted process RUNNING while it waits in the queue, so
+ * set_status sees it neither leave the cpu nor get it back. Reports both for
+ * the switch from the process that had the cpu, or NULL if set_status already
+ * reported it leaving, to the one that got it
+ */
+void report_rr_switch(SchedulerContext *context, Process *from, Process *to) {
+    if (context->events == NULL || from == to) {
+        return;
+    }
+    if (from != NULL && from->status == RUNNING) {
+        report_event(context, SCHED_PREEMPT, from);
+    }
+    if (to != NULL && to->status == RUNNING) {
+        report_event(context, SCHED_DISPATCH, to);
+    }
+}
+
+// executionStatus 2 marks the last cpu burst, 0 any other one
+static int rr_burst_phase(Process *process) {
+    return process->bursts_taken == process->burst_count ? 2 : 0;
+}
+
+/**
+ * One iteration of rrr's loop over state: unless the tick is being gone over
+ * again, the processes arriving and done with their io at it are queued, then
+ * the quantum is checked and the running process takes the tick, written to
+ * timeline unless that is NULL. A process that blocks or terminates hands the
+ * cpu on and the tick is gone over again with the next one, which is how rrr
+ * has always counted
+ * returns 1 once the tick is over, 0 if it is gone over again or
+ * RUN_NO_MEMORY if the ready queue could not grow
+ */
+int rrr_step(SchedulerContext *context, RrState *state, Timeline *timeline, Process **arrived, Process **woken) {
+    ProcessQueue *queue = state->queue;
+    Process *p;
+    int count, i;
+    context->now = state->tick;
+    // a tick retried after a block or termination already took its arrivals and io
+    if (!state->retry) {
+        count = get_arrived_processes(arrived, state->arrivals, state->tick);
+        for (i = 0; i < count; i++) {
+            p = arrived[i];
+            set_status(context, p, READY);
+            p->executionStatus = 0;
+            if (!enque(queue, p)) {
+                return RUN_NO_MEMORY;
+            }
         }
-        
-        /* Iterate over blocked processes and increase spent io time
-         * if the process finished its io time add it to the to be enqued
-         * list, and change its status to READY
-         */
-        i = 0;
-        while(i < blocked_count) {
-            temp = blocked_processes[i];
-            if (temp == NULL) {
-                break;
+
+        // spent io time counted up once per tick since the process blocked
+        count = get_io_completed_processes(woken, state->blocked, state->tick);
+        for (i = 0; i < count; i++) {
+            p = woken[i];
+            p->spent_io_time = p->io_time > p->spent_io_time ? p->io_time : p->spent_io_time + 1;
+            p->executionStatus = rr_burst_phase(p);
+            set_status(context, p, READY);
+            p->spent_cpu_time = 0;
+            if (!enque(queue, p)) {
+                return RUN_NO_MEMORY;
             }
-            temp->spent_io_time++;
-            if (temp->spent_io_time == temp->io_time) {
-                temp->status = READY;
-                to_be_enqued[to_be_enqued_count++] = temp;
-                to_be_enqued[to_be_enqued_count] = NULL;
-                
-                // swap it with the last blocked process in list
-                blocked_processes[i] = blocked_processes[blocked_count - 1];
-                blocked_processes[blocked_count - 1] = NULL;
-                blocked_count--;
-            } else {
-                i++;
+        }
+    }
+    state->retry = 0;
+
+    INSTRUMENT_BEGIN(DISPATCH_TIMING);
+    if (state->running == NULL) {
+        state->running = deque(queue);
+        report_rr_switch(context, NULL, state->running);
+    }
+    if (state->run_time >= context->quantum) {
+        // preempt the process, an idle cpu has nothing to put back
+        if (state->running != NULL) {
+            // only counted when another process gets the cpu
+            INSTRUMENT_ADD(preemptions, queue->count > 0);
+            Process *preempted = state->running;
+            if (!enque(queue, preempted)) {
+                return RUN_NO_MEMORY;
             }
+            state->running = deque(queue);
+            report_rr_switch(context, preempted, state->running);
+        }
+        state->run_time = 0;
+    }
+    INSTRUMENT_END(DISPATCH_TIMING);
+
+    p = state->running;
+    if (p == NULL) {
+        report_idle(context);
+        if (timeline != NULL) {
+            timeline_tick(timeline, state->tick);
         }
-        
-        /* check if process is running increase its CPU time */
-        if (running != NULL) {
-            running->spent_cpu_time++;
-            if (running->spent_cpu_time == running->cpu_time ||
-                running->spent_cpu_time == running->cpu_time * 2) {
-                // if * 2 then it should be terminated
-                if (running->spent_cpu_time == running->cpu_time * 2) {
-                    running->status = TERMINATED;
-                    running->turnaround = tick - running->turnaround;
-                    terminated_count++;
-                    running = NULL;
-                } else if (running->io_time != 0) {
-                    // it should be io blocked
-                    running->status = BLOCKING;
-                    blocked_processes[blocked_count++] = running;
-                    blocked_processes[blocked_count] = NULL;
-                    running = NULL;
+        state->tick++;
+        state->idle_count++;
+        INSTRUMENT_COUNT(idle_ticks);
+        return 1;
+    }
+    switch (p->status) {
+        case RUNNING:
+            if (p->spent_cpu_time >= p->cpu_time) {
+                if (p->executionStatus == 2 || !advance_burst(context->bursts, p)) {
+                    set_status(context, p, TERMINATED);
+                    p->turnaround = state->tick - 1;
+                    state->finished_count++;
+                    state->run_time = 0;
+                    state->running = deque(queue);
+                    report_rr_switch(context, NULL, state->running);
+                    state->retry = 1;
+                    return 0;
+                }
+                if (p->io_time > 0) {
+                    set_status(context, p, BLOCKING);
+                    block_process(state->blocked, p, rr_io_deadline(p, state->tick));
+                    p->spent_cpu_time = 0;
+                    state->running = deque(queue);
+                    report_rr_switch(context, NULL, state->running);
+                    state->retry = 1;
+                    return 0;
                 }
+                p->executionStatus = rr_burst_phase(p);
+                p->spent_cpu_time = 1;
+            } else {
+                p->spent_cpu_time++;
             }
-        }
-        
-        
-        // sort by process id and enque all
-        sort_process_list_by_id(to_be_enqued, to_be_enqued_count);
-        build_process_queue(&q, to_be_enqued);
-        
-        // choose a process to run
-        if (running == NULL) {
-            running = deque(&q);
-            if (running != NULL) {
-                running->status = RUNNING;
+            break;
+        case READY:
+            if (p->executionStatus == 0 || p->executionStatus == 2) {
+                set_status(context, p, RUNNING);
+                p->spent_cpu_time++;
             } else {
-                not_utilized_count++;
+                set_status(context, p, BLOCKING);
+                p->spent_io_time++;
+                block_process(state->blocked, p, rr_io_deadline(p, state->tick));
+                state->running = deque(queue);
+                report_rr_switch(context, NULL, state->running);
             }
-        }
-        
-        // print processes info
-        Process *current_process = *process_list;
-        int count = 0;
-        fprintf(f, "%d: ",tick);
-        while(current_process != NULL) {
-            switch (current_process->status) {
-                case 0:
-                    fprintf(f, "%d: running ",current_process->process_id);
-                    break;
-                case 2:
-                    fprintf(f, "%d: blocked ",current_process->process_id);
-                    break;
-                case 1:
-                    fprintf(f, "%d: ready ",current_process->process_id);
-                    break;
-                default:
-                    break;
+            break;
+        case BLOCKING:
+            if (p->spent_io_time >= p->io_time) {
+                set_status(context, p, RUNNING);
+                p->executionStatus = rr_burst_phase(p);
+                p->spent_cpu_time = 1;
             }
-            current_process = process_list[++count];
-        }
-        fprintf(f, "\n");
-        tick++;
+            break;
+        default:
+            break;
     }
-    tick -= 2;
-    not_utilized_count -= 1;
-    fprintf(f, "Finishing Time: %d\n", tick);
-    if (DEBUG_MODE) {
-        printf("%d\n", not_utilized_count);
+    if (timeline != NULL) {
+        timeline_tick(timeline, state->tick);
     }
-    fprintf(f, "CPU Utilization: %f\n", ((tick - not_utilized_count) * 1.0) / tick);
-    
-    // print processes info
-    Process *current_process = *process_list;
+    state->run_time++;
+    state->tick++;
+    return 1;
+}
+
+/**
+ * Writes the summary of an rrr run that ended at state->tick, every
+ * turnaround counted from the arrival tick itself and the latency summaries,
+ * and finishes the timeline
+ */
+void report_rr_results(SchedulerContext *context, Timeline *timeline, RrState *state) {
+    Process **process_list = context->process_list;
     int count = 0;
-    while(current_process != NULL) {
-        fprintf(f, "Turnaround process %d: %d\n", current_process->process_id,
-                current_process->turnaround);
+    report_summary(context, timeline, state->tick - 1, ((state->tick - state->idle_count) * 1.0) / state->tick);
+    Process *current_process = *process_list;
+    while (current_process != NULL) {
+        report_turnaround(context, timeline, current_process,
+                          current_process->turnaround - current_process->arrival_time + 1);
         current_process = process_list[++count];
     }
-    
-    return 0;
+    report_latency(context, timeline);
+    timeline_finish(timeline);
 }
 
-
-int rrr(Process **process_list, int no_of_processes, int quantum){
-    int numProcessesFinished = 0, currentProcessRunTime = 0;
+int rrr(SchedulerContext *context) {
+    Process **process_list = context->process_list;
+    int no_of_processes = context->no_of_processes;
+    // a preempted process is put back before the next one leaves, hence the extra slot
     ProcessQueue queue;
-    queue.head = queue.tail = NULL;
-    ProcessQueue dummy;
-    ProcessQueue ioQueue;
-    dummy.head = dummy.tail = NULL;
-    int shouldIncrementIO = 1;
-    ioQueue.head = ioQueue.tail = NULL;
-    Process *currentProcess = NULL;
-    int cpuTick=0;
-    int idleCount = 0;
-    while(numProcessesFinished < no_of_processes){
-        //didn't handle process id rubbish
-        int enquedIndex = 0;
-        Process** to_be_enqued = malloc(sizeof(Process) * (no_of_processes - 1));
-        int to_be_enqued_count = get_arrived_processes(to_be_enqued, process_list, cpuTick);
-        sort_process_list_by_id(to_be_enqued, to_be_enqued_count);
-//        while(enquedIndex < no_of_processes ){
-//            if(process_list[enquedIndex]->arrival_time == cpuTick){
-        for(int i = 0; i < to_be_enqued_count; i++){
-            Process *p = to_be_enqued[enquedIndex++];
-            p->status = 1;
-            p->executionStatus = 0;
-            enque(&queue, p);
-            
-            }
-//            enquedIndex++;
-//        }
-        
-
-        //increment IO
-        if(shouldIncrementIO ) {
-        while(ioQueue.head != NULL && peak(&ioQueue) != NULL){
-            Process* current = deque(&ioQueue);
-            current->spent_io_time++;
-            if(current->spent_io_time >= current->io_time){
-                current->executionStatus = 2;
-                current->status = 1;
-                current->spent_cpu_time = 0;
-                enque(&queue, current);
-            } else
-                enque(&dummy, current);
-        }
-        while(dummy.head != NULL && peak(&dummy) != NULL)
-            enque(&ioQueue, deque(&dummy));
+    int allocated = init_process_queue(&queue, no_of_processes + 1);
+    BlockedSet ioQueue;
+    allocated &= init_blocked_set(&ioQueue, no_of_processes);
+    ArrivalIndex arrivals;
+    allocated &= build_arrival_index(&arrivals, process_list, no_of_processes);
+    Process** to_be_enqued = malloc(sizeof(Process*) * (no_of_processes + 1));
+    Process** io_done = malloc(sizeof(Process*) * (no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 2);
+    int result = allocated && to_be_enqued != NULL && io_done != NULL ? RUN_OK : RUN_NO_MEMORY;
+    // go on from where a checkpoint left off, the ticks before it aren't written again
+    RrState state = {0, 0, 0, 0, NULL, &queue, &ioQueue, &arrivals, 0};
+    if (result == RUN_OK && context->restore_file != NULL) {
+        result = restore_rr_checkpoint(context, &state, context->restore_file);
+    }
+    if (result != RUN_OK) {
+        free_process_queue(&queue);
+        free_blocked_set(&ioQueue);
+        free_arrival_index(&arrivals);
+        free(to_be_enqued);
+        free(io_done);
+        return result;
+    }
+    int restoredTick = state.tick;
+    Timeline timeline;
+    timeline_init(&timeline, context->out, RR_TIMELINE, context->timeline_mode, context->summary_format,
+                  process_list, context->status, no_of_processes);
+    timeline.writer = context->writer;
+    subscribe_timeline(context, &timeline);
+    while (state.finished_count < no_of_processes) {
+        // a checkpoint goes between two ticks, never in the middle of one being retried
+        if (context->checkpoint_file != NULL && !state.retry && state.tick != restoredTick &&
+            context->checkpoint_interval > 0 && state.tick % context->checkpoint_interval == 0) {
+            save_rr_checkpoint(context, &state, context->checkpoint_file);
         }
-        shouldIncrementIO = 1;
-        if(currentProcess == NULL)
-            currentProcess = deque(&queue);
-        
-        if(currentProcessRunTime >= quantum){
-            //preempt the process
-                enque(&queue, currentProcess);
-            currentProcess = deque(&queue);
-            currentProcessRunTime = 0;
+        if (rrr_step(context, &state, &timeline, to_be_enqued, io_done) < 0) {
+            result = RUN_NO_MEMORY;
+            break;
         }
-        if(currentProcess == NULL){
-            int count = 0;
-            Process *current_process = *process_list;
-            while(current_process != NULL) {
-                switch (current_process->status) {
-                    case 0:
-                        printf("%d | %d: running ",cpuTick,current_process->process_id);
-                        break;
-                    case 2:
-                        printf( "%d | %d: blocked ",cpuTick, current_process->process_id);
-                        break;
-                    case 1:
-                        printf( "%d | %d: ready ",cpuTick,current_process->process_id);
-                        break;
-                    default:
-                        break;
-                }
-                current_process = process_list[++count];
-            }
-            printf("\n");
+    }
+
+    if (result == RUN_OK) {
+        report_rr_results(context, &timeline, &state);
+    } else {
+        timeline_finish(&timeline);
+    }
+    free_process_queue(&queue);
+    free_blocked_set(&ioQueue);
+    free_arrival_index(&arrivals);
+    free(to_be_enqued);
+    free(io_done);
+    return result;
+}
+
+
+/**
+ * Sets up an empty multilevel feedback queue for the no_of_processes
+ * processes starting at processes, all of them at level 0
+ * returns 1, or 0 if there is not enough memory
+ */
+int init_feedback_queue(FeedbackQueue *q, Process *processes, int no_of_processes, int level_count) {
+    int i;
+    size_t slots = (size_t) no_of_processes + 1;
+    memset(q, 0, sizeof(FeedbackQueue));
+    if (level_count < 1) {
+        level_count = 1;
+    } else if (level_count > MLFQ_MAX_LEVELS) {
+        level_count = MLFQ_MAX_LEVELS;
+    }
+    q->processes = processes;
+    q->level_count = level_count;
+    // one block for the per level ends, one for the per slot arrays
+    q->head = malloc(sizeof(int) * 2 * level_count);
+    q->next = calloc(slots * 4, sizeof(int));
+    INSTRUMENT_ADD(allocations, 2);
+    if (q->head == NULL || q->next == NULL) {
+        free_feedback_queue(q);
+        return 0;
+    }
+    q->tail = q->head + level_count;
+    q->level = q->next + slots;
+    q->used = q->level + slots;
+    q->epoch = q->used + slots;
+    for (i = 0; i < level_count; i++) {
+        q->head[i] = q->tail[i] = -1;
+    }
+    return 1;
+}
+
+void free_feedback_queue(FeedbackQueue *q) {
+    free(q->head);
+    free(q->next);
+    memset(q, 0, sizeof(FeedbackQueue));
+}
+
+// the slot of process, its level and used quantum brought up to the last boost
+static int feedback_slot(FeedbackQueue *q, Process *process) {
+    int slot = (int) (process - q->processes);
+    if (q->epoch[slot] != q->boosts) {
+        q->epoch[slot] = q->boosts;
+        q->level[slot] = 0;
+        q->used[slot] = 0;
+    }
+    return slot;
+}
+
+int feedback_level(FeedbackQueue *q, Process *process) {
+    return q->level[feedback_slot(q, process)];
+}
+
+/**
+ * Puts a process at the back of its level
+ */
+void feedback_enque(FeedbackQueue *q, Process *process) {
+    int slot = feedback_slot(q, process);
+    int level = q->level[slot];
+    q->next[slot] = -1;
+    if (q->head[level] < 0) {
+        q->head[level] = slot;
+        q->nonempty |= 1u << level;
+    } else {
+        q->next[q->tail[level]] = slot;
+    }
+    q->tail[level] = slot;
+    q->count++;
+    INSTRUMENT_COUNT(queue_ops);
+}
+
+/**
+ * Takes the first process of the highest level that has one
+ * returns it, or NULL if there is none
+ */
+Process* feedback_deque(FeedbackQueue *q) {
+    if (q->nonempty == 0) {
+        return NULL;
+    }
+    int level = ffs((int) q->nonempty) - 1;
+    int slot = q->head[level];
+    q->head[level] = q->next[slot];
+    if (q->head[level] < 0) {
+        q->tail[level] = -1;
+        q->nonempty &= ~(1u << level);
+    }
+    q->count--;
+    INSTRUMENT_COUNT(queue_ops);
+    return &q->processes[slot];
+}
 
-            cpuTick++;
-            idleCount++;
+/**
+ * Counts a tick the process ran against quantum, its level's quantum, and
+ * moves it a level down once it has run all of it
+ * returns 1 if it just used up its quantum, 0 otherwise
+ */
+int charge_feedback_tick(FeedbackQueue *q, Process *process, int quantum) {
+    int slot = feedback_slot(q, process);
+    if (++q->used[slot] < quantum) {
+        return 0;
+    }
+    q->used[slot] = 0;
+    if (q->level[slot] < q->level_count - 1) {
+        q->level[slot]++;
+    }
+    return 1;
+}
+
+/**
+ * Moves every process back to level 0, the ready ones keeping their order
+ * from the highest level to the lowest
+ */
+void boost_feedback_queue(FeedbackQueue *q) {
+    int level;
+    for (level = 1; level < q->level_count; level++) {
+        if (q->head[level] < 0) {
             continue;
         }
-            switch(currentProcess->status){
-                    // 0: Running, 1: Ready, 2: Blocking, 3: Terminated, None: 4
-                case 0:
-                    if(currentProcess->spent_cpu_time >= currentProcess->cpu_time){
-                        if(currentProcess->executionStatus == 2){
-                                currentProcess->status = 3;
-                            currentProcess->turnaround = cpuTick - 1;
-                                numProcessesFinished++;
-                                currentProcessRunTime = 0;
-                            currentProcess = deque(&queue);
-                            shouldIncrementIO = 0;
-                            continue;
-                        } else {
-                            if(currentProcess->io_time > 0){
-                        currentProcess->status = 2;
-                            enque(&ioQueue, currentProcess);
-                            currentProcess->spent_cpu_time = 0;
-                            currentProcess = deque(&queue);
-                            shouldIncrementIO = 0;
-                            continue; // because didn't do anything this cycle
-                            } else {
-                                currentProcess->status = 0;
-                                currentProcess->executionStatus = 2;
-                                currentProcess->spent_cpu_time = 1;
-                            }
-                        }
-
-
-                    }else {
-                        currentProcess->spent_cpu_time++;
-
-                    }
-                    break;
-                case 1:
-                    if(currentProcess->executionStatus == 0 || currentProcess->executionStatus == 2){
-                        currentProcess->status = 0;
-                        currentProcess->spent_cpu_time++;
-                    } else {
-                        currentProcess->status = 2;
-                        currentProcess->spent_io_time++;
-                        enque(&ioQueue, currentProcess);
-                        currentProcess = deque(&queue);
-                    }
-                    break;
-                case 2:
-                    if(currentProcess->spent_io_time >= currentProcess->io_time){
-                        currentProcess->status = 0;
-                        currentProcess->executionStatus = 2;
-                        currentProcess->spent_cpu_time = 1;
-//                        printf("%d Process(%d) running\n",cpuTick,currentProcess->process_id);
-                    } else {
-//                        currentProcess->spent_io_time++;
-//                        printf("%d Process(%d) blocking\n",cpuTick,currentProcess->process_id);
-                    }
-                    break;
-                default:
-                    break;
-            }
-        int count = 0;
-        Process *current_process = *process_list;
-        while(current_process != NULL) {
-            switch (current_process->status) {
-                case 0:
-                    printf("%d | %d: running ",cpuTick,current_process->process_id);
-                    break;
-                case 2:
-                    printf( "%d | %d: blocked ",cpuTick, current_process->process_id);
-                    break;
-                case 1:
-                    printf( "%d | %d: ready ",cpuTick,current_process->process_id);
-                    break;
-                default:
-                    break;
-            }
-            current_process = process_list[++count];
+        if (q->head[0] < 0) {
+            q->head[0] = q->head[level];
+        } else {
+            q->next[q->tail[0]] = q->head[level];
         }
-        printf("\n");
-
-        
-        currentProcessRunTime++;
-        cpuTick++;
-    }
-    
-    printf("Finishing Time: %d\n", cpuTick - 1);
-    printf("CPU Utilization: %f\n" , ((cpuTick -idleCount) * 1.0) / cpuTick);
-    int count = 0;
-    Process *current_process = *process_list;
-    while(current_process != NULL) {
-        printf("Turnaround process %d: %d\n", current_process->process_id,
-                current_process->turnaround - current_process->arrival_time + 1);
-        current_process = process_list[++count];
+        q->tail[0] = q->tail[level];
+        q->head[level] = q->tail[level] = -1;
     }
-    return 0;
+    q->nonempty = q->nonempty != 0 ? 1u : 0u;
+    q->boosts++;
 }
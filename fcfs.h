@@ -4,20 +4,116 @@
 
 #ifndef SCHEDULERS_FCFS_H
 #define SCHEDULERS_FCFS_H
-
-#endif //SCHEDULERS_FCFS_H
 #include "process.h"
+#include "scheduler.h"
 
-typedef struct ProcessQueueNode {
-    Process *process;
-    struct ProcessQueueNode *next;
-} ProcessQueueNode;
-
+// fixed capacity ring buffer of processes
 typedef struct ProcessQueue {
-    ProcessQueueNode *head;
-    ProcessQueueNode *tail;
+    Process **slots;
+    int capacity;
+    int head; // slot of the first process in the queue
+    int count;
 } ProcessQueue;
 
-int run_fcfs(Process **process_list, int no_of_processes);
+typedef struct BlockedEntry {
+    int deadline; // tick at which the io completes
+    long seq; // processes completing together leave in the order they blocked
+    Process *process;
+} BlockedEntry;
+
+// io blocked processes in a min-heap ordered by the tick their io completes
+typedef struct BlockedSet {
+    BlockedEntry *heap;
+    int count;
+    int capacity;
+    long next_seq;
+} BlockedSet;
+
+// processes ordered by arrival time then process id, with a cursor at the next one to arrive
+typedef struct ArrivalIndex {
+    Process **order;
+    int count;
+    int next;
+} ArrivalIndex;
+
+// levels a multilevel feedback queue can have, one bit of its bitmap each
+#define MLFQ_MAX_LEVELS 32
+#define DEFAULT_MLFQ_LEVELS 3
+
+/* The ready processes of a multilevel feedback run, a fifo list per level,
+ * level 0 the highest. The lists are linked through next by process slot, an
+ * index into processes, so a process goes in and out without allocating, and
+ * nonempty has bit l set while level l has a process so the highest one is
+ * found with ffs. A boost splices every level onto level 0 and counts itself
+ * in boosts, a process whose epoch is older is at level 0 with none of its
+ * quantum used, so boosting costs the same however many processes there are.
+ */
+typedef struct FeedbackQueue {
+    Process *processes;
+    int level_count;
+    unsigned int nonempty;
+    int *head; // per level, slot of its first process or -1
+    int *tail; // per level, slot of its last process or -1
+    int *next; // per slot, the slot after it in its level or -1
+    int *level; // per slot, the level it is at as of boost epoch[slot]
+    int *used; // per slot, ticks of its level's quantum it has run
+    int *epoch; // per slot
+    int boosts;
+    int count; // processes in the queue, at any level
+} FeedbackQueue;
 
-int rrr(Process **process_list, int no_of_processes, int quantum);
+// rrr's loop variables, the processes and their status are in the context
+typedef struct RrState {
+    int tick;
+    int idle_count;
+    int run_time;
+    int finished_count;
+    Process *running;
+    ProcessQueue *queue;
+    BlockedSet *blocked;
+    ArrivalIndex *arrivals;
+    int retry; // the tick is gone over again without its arrivals and io
+} RrState;
+
+// what a tick of cpu time did to the process that ran it, see run_burst_tick
+enum BurstStep {BURST_GOES_ON, BURST_BLOCKS, BURST_TERMINATES};
+
+int init_process_queue(ProcessQueue *q, int capacity);
+void free_process_queue(ProcessQueue *q);
+int enque(ProcessQueue *q, Process *process);
+Process* deque(ProcessQueue *q);
+Process* peak(ProcessQueue *q);
+int enque_by_id(ProcessQueue *q, Process **first, int first_count, Process **second, int second_count);
+
+int init_blocked_set(BlockedSet *blocked, int capacity);
+void free_blocked_set(BlockedSet *blocked);
+void block_process(BlockedSet *blocked, Process *process, int deadline);
+int next_io_completion(BlockedSet *blocked);
+int get_io_completed_processes(Process **completed, BlockedSet *blocked, int tick);
+
+int build_arrival_index(ArrivalIndex *index, Process **process_list, int no_of_processes);
+void free_arrival_index(ArrivalIndex *index);
+int next_arrival_time(ArrivalIndex *index);
+int get_arrived_processes(Process** arrived, ArrivalIndex *index, int tick);
+
+int admit_arrivals(SchedulerContext *context, ArrivalIndex *arrivals, Process **arrived, int tick);
+int wake_processes(SchedulerContext *context, BlockedSet *blocked, Process **woken, int tick);
+int run_burst_tick(const unsigned char *bursts, Process *process);
+void wait_for_io(BlockedSet *blocked, Process *process, int tick);
+void terminate_process(SchedulerContext *context, Process *process, int tick);
+int advance_running(SchedulerContext *context, BlockedSet *blocked, Process *running, int tick);
+
+int init_feedback_queue(FeedbackQueue *q, Process *processes, int no_of_processes, int level_count);
+void free_feedback_queue(FeedbackQueue *q);
+void feedback_enque(FeedbackQueue *q, Process *process);
+Process* feedback_deque(FeedbackQueue *q);
+int feedback_level(FeedbackQueue *q, Process *process);
+int charge_feedback_tick(FeedbackQueue *q, Process *process, int quantum);
+void boost_feedback_queue(FeedbackQueue *q);
+
+int rrr(SchedulerContext *context);
+int rrr_step(SchedulerContext *context, RrState *state, Timeline *timeline, Process **arrived, Process **woken);
+void report_rr_switch(SchedulerContext *context, Process *from, Process *to);
+void report_rr_results(SchedulerContext *context, Timeline *timeline, RrState *state);
+
+#endif //SCHEDULERS_FCFS_H
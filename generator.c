@@ -0,0 +1,101 @@
+/**
+ * Workload Generator
+ *
+ * Writes a seeded, reproducible processes info file, one
+ * "process_id cpu_time io_time arrival_time" line per process, ordered by
+ * arrival. Processes are streamed out as they are drawn so the count is only
+ * limited by the int process ids.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <limits.h>
+#include "generator.h"
+
+// a bursty arrival pattern sends processes in groups this large on average
+#define MEAN_GROUP_SIZE 32
+// and within a group they come this many times faster than the average rate
+#define GROUP_SPEEDUP 8
+// tail index of the pareto bursts, the smaller the heavier the tail
+#define PARETO_ALPHA 1.5
+
+// splitmix64, small and good enough to draw workloads from
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// uniform in (0, 1], never 0 so it can be passed to log and pow
+static double next_unit(uint64_t *state) {
+    return ((next_random(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static double next_exponential(uint64_t *state, double mean) {
+    return -log(next_unit(state)) * mean;
+}
+
+static int next_burst(uint64_t *state, const GeneratorOptions *options, double mean) {
+    double value;
+    if (options->bursts == PARETO_BURSTS) {
+        // scale so the uncut distribution has the requested mean
+        value = mean * (PARETO_ALPHA - 1) / PARETO_ALPHA / pow(next_unit(state), 1 / PARETO_ALPHA);
+        if (value > options->max_burst) {
+            value = options->max_burst;
+        }
+    } else {
+        value = next_unit(state) * (2 * mean - 1) + 0.5;
+    }
+    return value < 1 ? 1 : (int) value;
+}
+
+void default_generator_options(GeneratorOptions *options) {
+    options->seed = 1;
+    options->no_of_processes = 1000;
+    options->arrivals = POISSON_ARRIVALS;
+    options->arrival_rate = 0.1;
+    options->bursts = UNIFORM_BURSTS;
+    options->mean_cpu = 5;
+    options->mean_io = 5;
+    options->io_ratio = 0.5;
+    options->max_burst = 1000;
+}
+
+/**
+ * Writes the workload described by options to out
+ * returns 0, or -1 if the options make no sense or the arrivals overflow an int
+ */
+int generate_workload(FILE *out, const GeneratorOptions *options) {
+    uint64_t state = options->seed;
+    double time = 0, gap = 1 / options->arrival_rate;
+    long long i;
+    int group_left = 0, cpu_time, io_time;
+
+    if (options->no_of_processes < 0 || options->no_of_processes > INT_MAX || options->arrival_rate <= 0 ||
+        options->mean_cpu < 1 || options->mean_io < 1 || options->max_burst < 1) {
+        return -1;
+    }
+
+    for (i = 0; i < options->no_of_processes; i++) {
+        if (options->arrivals == BURSTY_ARRIVALS) {
+            if (group_left == 0) {
+                // the time a group saves by coming in fast is spent idle before it
+                group_left = 1 + (int) next_exponential(&state, MEAN_GROUP_SIZE - 1);
+                time += next_exponential(&state, gap * group_left * (GROUP_SPEEDUP - 1) / GROUP_SPEEDUP);
+            }
+            group_left--;
+            time += next_exponential(&state, gap / GROUP_SPEEDUP);
+        } else {
+            time += next_exponential(&state, gap);
+        }
+        if (time > INT_MAX) {
+            return -1;
+        }
+
+        cpu_time = next_burst(&state, options, options->mean_cpu);
+        io_time = next_unit(&state) <= options->io_ratio ? next_burst(&state, options, options->mean_io) : 0;
+        fprintf(out, "%lld %d %d %d\n", i, cpu_time, io_time, (int) time);
+    }
+    return 0;
+}
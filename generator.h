@@ -0,0 +1,28 @@
+/**
+ * Workload Generator
+ */
+
+#ifndef SCHEDULERS_GENERATOR_H
+#define SCHEDULERS_GENERATOR_H
+#include <stdio.h>
+#include <stdint.h>
+
+enum ArrivalPattern {POISSON_ARRIVALS, BURSTY_ARRIVALS};
+enum BurstDistribution {UNIFORM_BURSTS, PARETO_BURSTS};
+
+typedef struct GeneratorOptions {
+    uint64_t seed;
+    long long no_of_processes;
+    int arrivals;
+    double arrival_rate; // processes arriving per tick, on average
+    int bursts;
+    double mean_cpu; // mean cpu time of a burst
+    double mean_io; // mean io time of the processes that do io
+    double io_ratio; // fraction of processes that do io
+    int max_burst; // pareto bursts are cut off here
+} GeneratorOptions;
+
+void default_generator_options(GeneratorOptions *options);
+int generate_workload(FILE *out, const GeneratorOptions *options);
+
+#endif //SCHEDULERS_GENERATOR_H
@@ -0,0 +1,81 @@
+/**
+ * Latency Histogram
+ *
+ * Log bucketed in the HDR histogram layout: a fixed number of buckets per
+ * power of two, so memory stays the same however many values are recorded
+ * while percentiles keep a fixed relative precision.
+ */
+
+#include <string.h>
+#include "histogram.h"
+
+#define SUB_BUCKET_HALF (1 << HISTOGRAM_SUB_BUCKET_BITS)
+
+static int bucket_of(int value) {
+    if (value < 2 * SUB_BUCKET_HALF) {
+        return value < 0 ? 0 : value;
+    }
+    // shift the value down until it is in [SUB_BUCKET_HALF, 2 * SUB_BUCKET_HALF)
+    int shift = 31 - __builtin_clz((unsigned int) value) - HISTOGRAM_SUB_BUCKET_BITS;
+    return shift * SUB_BUCKET_HALF + (value >> shift);
+}
+
+// the largest value that lands in the bucket
+static long long highest_in_bucket(int bucket) {
+    if (bucket < 2 * SUB_BUCKET_HALF) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKET_HALF - 1;
+    long long sub_bucket = bucket - shift * SUB_BUCKET_HALF;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void histogram_init(Histogram *h) {
+    memset(h, 0, sizeof(Histogram));
+}
+
+void histogram_record(Histogram *h, int value) {
+    if (value < 0) {
+        value = 0;
+    }
+    h->counts[bucket_of(value)]++;
+    h->total++;
+    h->sum += value;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+/**
+ * returns the value percentile percent of the recorded values are at or
+ * below, as the top of its bucket but never above the largest value, 0 if
+ * nothing was recorded
+ */
+int histogram_percentile(Histogram *h, double percentile) {
+    long long rank, seen = 0;
+    int bucket;
+    if (h->total == 0) {
+        return 0;
+    }
+    rank = (long long) (percentile / 100 * h->total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        seen += h->counts[bucket];
+        if (seen >= rank) {
+            long long highest = highest_in_bucket(bucket);
+            return highest < h->max ? (int) highest : h->max;
+        }
+    }
+    return h->max;
+}
+
+void summarize_histogram(Histogram *h, LatencySummary *summary) {
+    summary->mean = h->total > 0 ? (double) h->sum / h->total : 0;
+    summary->p50 = histogram_percentile(h, 50);
+    summary->p90 = histogram_percentile(h, 90);
+    summary->p99 = histogram_percentile(h, 99);
+    summary->p999 = histogram_percentile(h, 99.9);
+    summary->max = h->max;
+}
@@ -0,0 +1,39 @@
+/**
+ * Latency Histogram
+ */
+
+#ifndef SCHEDULERS_HISTOGRAM_H
+#define SCHEDULERS_HISTOGRAM_H
+
+/* Values below 128 have a bucket each, larger ones share buckets 1/64 of their
+ * power of two wide, so anything read back is at most 1/64 above the value
+ * recorded. 1664 buckets cover every non negative int, negative values are
+ * counted as 0.
+ */
+#define HISTOGRAM_SUB_BUCKET_BITS 6
+#define HISTOGRAM_BUCKETS ((31 - HISTOGRAM_SUB_BUCKET_BITS) * (1 << HISTOGRAM_SUB_BUCKET_BITS) + \
+                           (1 << HISTOGRAM_SUB_BUCKET_BITS))
+
+typedef struct Histogram {
+    long long counts[HISTOGRAM_BUCKETS];
+    long long total;
+    long long sum;
+    int max;
+} Histogram;
+
+// what the reports show of a histogram, all 0 if nothing was recorded
+typedef struct LatencySummary {
+    double mean;
+    int p50;
+    int p90;
+    int p99;
+    int p999;
+    int max;
+} LatencySummary;
+
+void histogram_init(Histogram *h);
+void histogram_record(Histogram *h, int value);
+int histogram_percentile(Histogram *h, double percentile);
+void summarize_histogram(Histogram *h, LatencySummary *summary);
+
+#endif //SCHEDULERS_HISTOGRAM_H
@@ -0,0 +1,96 @@
+/**
+ * Instrumentation
+ *
+ * Only built into anything with -DINSTRUMENT=1, see instrument.h.
+ */
+
+#include "instrument.h"
+
+#if INSTRUMENT
+
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "timeline.h"
+
+__thread Instrument instrument;
+
+// what the threads that already exited counted
+static Instrument merged;
+static pthread_mutex_t merged_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *timing_names[NO_OF_TIMINGS] = {"load", "sort", "arrival", "io", "dispatch", "output"};
+
+long long instrument_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void instrument_time(int timing, long long start) {
+    instrument.timing_ns[timing] += instrument_now() - start;
+    instrument.timing_calls[timing]++;
+}
+
+/**
+ * Adds the calling thread's counts to the process wide ones and starts it over
+ */
+void instrument_merge_thread(void) {
+    int i;
+    pthread_mutex_lock(&merged_lock);
+    merged.queue_ops += instrument.queue_ops;
+    merged.context_switches += instrument.context_switches;
+    merged.preemptions += instrument.preemptions;
+    merged.idle_ticks += instrument.idle_ticks;
+    merged.io_completions += instrument.io_completions;
+    merged.allocations += instrument.allocations;
+    for (i = 0; i < NO_OF_TIMINGS; i++) {
+        merged.timing_ns[i] += instrument.timing_ns[i];
+        merged.timing_calls[i] += instrument.timing_calls[i];
+    }
+    pthread_mutex_unlock(&merged_lock);
+    memset(&instrument, 0, sizeof(Instrument));
+}
+
+/**
+ * Writes everything counted so far, as json or as metric,name,value csv rows
+ */
+void instrument_report(FILE *out, int format) {
+    const char *counter_names[] = {"queue_ops", "context_switches", "preemptions", "idle_ticks",
+                                   "io_completions", "allocations"};
+    long counters[6];
+    int i;
+
+    instrument_merge_thread();
+    counters[0] = merged.queue_ops;
+    counters[1] = merged.context_switches;
+    counters[2] = merged.preemptions;
+    counters[3] = merged.idle_ticks;
+    counters[4] = merged.io_completions;
+    counters[5] = merged.allocations;
+
+    if (format == SUMMARY_CSV) {
+        fprintf(out, "metric,name,value\n");
+        for (i = 0; i < 6; i++) {
+            fprintf(out, "counter,%s,%ld\n", counter_names[i], counters[i]);
+        }
+        for (i = 0; i < NO_OF_TIMINGS; i++) {
+            fprintf(out, "seconds,%s,%.9f\ncalls,%s,%ld\n", timing_names[i], merged.timing_ns[i] / 1e9,
+                    timing_names[i], merged.timing_calls[i]);
+        }
+    } else {
+        fprintf(out, "{\"counters\": {");
+        for (i = 0; i < 6; i++) {
+            fprintf(out, "%s\"%s\": %ld", i > 0 ? ", " : "", counter_names[i], counters[i]);
+        }
+        fprintf(out, "}, \"phases\": {");
+        for (i = 0; i < NO_OF_TIMINGS; i++) {
+            fprintf(out, "%s\"%s\": {\"seconds\": %.9f, \"calls\": %ld}", i > 0 ? ", " : "", timing_names[i],
+                    merged.timing_ns[i] / 1e9, merged.timing_calls[i]);
+        }
+        fprintf(out, "}}\n");
+    }
+    fflush(out);
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Instrumentation
+ *
+ * Hot path counters and phase timers, compiled in with -DINSTRUMENT=1 on every
+ * file of a build and compiled out to nothing otherwise. Every thread counts
+ * into its own copy, worker threads merge theirs before they exit and the
+ * report merges the calling thread's.
+ */
+
+#ifndef SCHEDULERS_INSTRUMENT_H
+#define SCHEDULERS_INSTRUMENT_H
+#include <stdio.h>
+
+#ifndef INSTRUMENT
+#define INSTRUMENT 0
+#endif
+
+// the phases that are timed, each one adds up over all of its calls
+enum InstrumentTiming {LOAD_TIMING, SORT_TIMING, ARRIVAL_TIMING, IO_TIMING, DISPATCH_TIMING, OUTPUT_TIMING,
+                       NO_OF_TIMINGS};
+
+typedef struct Instrument {
+    long queue_ops; // ready, blocked and event queue pushes and pops
+    // a process going to RUNNING from another state, rrr keeps a preempted process
+    // RUNNING while it waits so there its resumptions only show up as preemptions
+    long context_switches;
+    long preemptions; // the running process sent back for another one
+    long idle_ticks;
+    long io_completions;
+    long allocations;
+    long long timing_ns[NO_OF_TIMINGS];
+    long timing_calls[NO_OF_TIMINGS];
+} Instrument;
+
+#if INSTRUMENT
+
+extern __thread Instrument instrument;
+
+long long instrument_now(void);
+void instrument_time(int timing, long long start);
+void instrument_merge_thread(void);
+void instrument_report(FILE *out, int format);
+
+#define INSTRUMENT_COUNT(counter) (instrument.counter++)
+#define INSTRUMENT_ADD(counter, n) (instrument.counter += (n))
+#define INSTRUMENT_BEGIN(timing) long long timing##_start = instrument_now()
+#define INSTRUMENT_END(timing) instrument_time(timing, timing##_start)
+#define INSTRUMENT_MERGE_THREAD() instrument_merge_thread()
+// format is SUMMARY_JSON or SUMMARY_CSV
+#define INSTRUMENT_REPORT(out, format) instrument_report(out, format)
+
+#else
+
+#define INSTRUMENT_COUNT(counter) ((void) 0)
+#define INSTRUMENT_ADD(counter, n) ((void) 0)
+#define INSTRUMENT_BEGIN(timing) ((void) 0)
+#define INSTRUMENT_END(timing) ((void) 0)
+#define INSTRUMENT_MERGE_THREAD() ((void) 0)
+#define INSTRUMENT_REPORT(out, format) ((void) (out), (void) (format))
+
+#endif
+
+#endif //SCHEDULERS_INSTRUMENT_H
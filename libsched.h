@@ -0,0 +1,45 @@
+/**
+ * Scheduler Library
+ *
+ * Everything but main.c, for programs that run the simulations themselves and
+ * take the results as they happen instead of parsing FCFS.out or stdout back.
+ *
+ * build: make libsched.a      static
+ *        make libsched.so     shared
+ * link:  gcc -pthread -o program program.c -L. -lsched
+ *
+ * A run over a processes info file, its events going to a callback:
+ *
+ *   Workload workload;
+ *   SchedulerContext context;
+ *   EventSink sink;
+ *   load_workload(&workload, file_name);
+ *   sort_process_list(workload.process_list, workload.no_of_processes);
+ *   init_scheduler_context(&context, workload.process_list, workload.no_of_processes);
+ *   context.alg_type = RR_ALGORITHM;
+ *   context.quantum = 2;
+ *   init_event_sink(&sink, on_event, data, NULL);
+ *   context.events = &sink;
+ *   run_scheduler(&context);
+ *
+ * The results end up in the context, finishing_time, cpu_utilization and the
+ * latency histograms among them, with out left NULL nothing is written.
+ * The timeline written to out is itself one more subscriber to the run's
+ * events, chained in front of the caller's sink for the run. To
+ * take the events on another thread instead, hand init_event_sink a ring of
+ * SchedEvent made with init_spsc_ring, pop it there with spsc_pop or
+ * spsc_try_pop, and spsc_close it once run_scheduler returns. A multi cpu
+ * run spread over host_threads threads still hands every event over on the
+ * thread that called run_scheduler, in the same order whatever the number of
+ * threads, which is what spreading it is for; it does not run faster.
+ */
+
+#ifndef SCHEDULERS_LIBSCHED_H
+#define SCHEDULERS_LIBSCHED_H
+#include "process.h"
+#include "loader.h"
+#include "scheduler.h"
+#include "sched_events.h"
+#include "pipeline.h"
+
+#endif //SCHEDULERS_LIBSCHED_H
@@ -0,0 +1,536 @@
+/**
+ * Workload Loader
+ *
+ * Memory maps the processes info file and parses it with a hand written
+ * scanner, one process per line: process_id cpu_time io_time arrival_time.
+ * The records are kept in one arena that doubles whenever it fills up.
+ *
+ * A process runs cpu_time, blocks for io_time and runs cpu_time again, unless
+ * its line goes on past the priority column with the rest of a burst list:
+ *   process_id cpu_time io_time arrival_time priority cpu io cpu ... cpu
+ * so it runs cpu_time, blocks for io_time, then follows the list, which has
+ * to end with a cpu burst. The lists go into the workload's burst table.
+ *
+ * Binary workloads (see loader.h) skip parsing altogether: on a little endian
+ * host whose Process matches the record size, the mapped file itself becomes
+ * the process array and pages are only copied once the simulation writes them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "loader.h"
+#include "instrument.h"
+
+#define INITIAL_CAPACITY 1024
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+// only the first malformed lines are printed, the rest are just counted
+#define MAX_REPORTED_LINES 20
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Scans an optionally signed decimal int at the cursor, which has to be
+ * followed by a blank or the end of the line
+ * returns 1 and moves the cursor past it, 0 if there is no such int or it overflows
+ */
+static int scan_int(const char **cursor, const char *line_end, int *value) {
+    const char *p = *cursor;
+    long long result = 0;
+    int negative = 0;
+
+    while (p < line_end && is_blank(*p)) {
+        p++;
+    }
+    if (p < line_end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == line_end || *p < '0' || *p > '9') {
+        return 0;
+    }
+    while (p < line_end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        if (result > (long long) INT_MAX + 1) {
+            return 0;
+        }
+        p++;
+    }
+    if (p < line_end && !is_blank(*p)) {
+        return 0;
+    }
+    if (negative) {
+        result = -result;
+    }
+    if (result > INT_MAX || result < INT_MIN) {
+        return 0;
+    }
+
+    *value = (int) result;
+    *cursor = p;
+    return 1;
+}
+
+static void init_process(Process *process, int process_id, int cpu_time, int io_time, int arrival_time,
+                         int priority) {
+    memset(process, 0, sizeof(Process));
+    process->process_id = process_id;
+    process->cpu_time = cpu_time;
+    process->io_time = io_time;
+    process->arrival_time = arrival_time;
+    process->priority = priority;
+    process->status = NONE;
+    // cpu, io, cpu is a burst list of its own whose last burst repeats the first
+    process->burst_offset = -1;
+    process->burst_count = 1;
+    process->work = 2 * cpu_time + io_time;
+}
+
+static int append_process(Workload *workload, const Process *process) {
+    if (workload->no_of_processes == workload->capacity) {
+        int capacity = workload->capacity == 0 ? INITIAL_CAPACITY : workload->capacity * 2;
+        if (capacity < workload->capacity) {
+            return 0;
+        }
+        Process *processes = realloc(workload->processes, sizeof(Process) * (size_t) capacity);
+        INSTRUMENT_COUNT(allocations);
+        if (processes == NULL) {
+            return 0;
+        }
+        workload->processes = processes;
+        workload->capacity = capacity;
+    }
+
+    workload->processes[workload->no_of_processes++] = *process;
+    return 1;
+}
+
+/**
+ * Appends the burst list that follows the priority column at the cursor to
+ * bursts, coded against the process's first cpu and io burst
+ * returns 1, 0 if the list doesn't end with a cpu burst or -1 if the table
+ * can't grow
+ */
+static int parse_burst_list(const char **cursor, const char *line_end, Process *process, BurstTable *bursts) {
+    int previous_cpu = process->cpu_time, previous_io = process->io_time, burst;
+    size_t start = bursts->length;
+    process->burst_offset = (int) start;
+    process->next_burst = (int) start;
+    process->burst_count = 0;
+    process->work = process->cpu_time + process->io_time;
+    while (scan_int(cursor, line_end, &burst)) {
+        // even bursts of the list are cpu bursts, odd ones io bursts
+        int *previous = process->burst_count % 2 == 0 ? &previous_cpu : &previous_io;
+        if (!append_burst(bursts, *previous, burst)) {
+            return -1;
+        }
+        *previous = burst;
+        process->burst_count++;
+        process->work += burst;
+    }
+    if (process->burst_count % 2 == 0) {
+        bursts->length = start;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Parses one line of a text workload, [line, line_end) without its newline,
+ * any burst list it has goes into bursts or makes it malformed if that is NULL
+ * returns 1 if it holds a process, 0 if it is blank, -1 if it is malformed or
+ * -2 if the burst table can't grow
+ */
+static int parse_line(const char *line, const char *line_end, Process *process, BurstTable *bursts) {
+    const char *cursor = line;
+    int process_id, cpu_time, io_time, arrival_time, priority, parsed;
+
+    while (cursor < line_end && is_blank(*cursor)) {
+        cursor++;
+    }
+    if (cursor == line_end) {
+        return 0;
+    }
+    if (!scan_int(&cursor, line_end, &process_id) ||
+        !scan_int(&cursor, line_end, &cpu_time) ||
+        !scan_int(&cursor, line_end, &io_time) ||
+        !scan_int(&cursor, line_end, &arrival_time)) {
+        return -1;
+    }
+    // the priority column is optional
+    if (!scan_int(&cursor, line_end, &priority)) {
+        priority = 0;
+    }
+    init_process(process, process_id, cpu_time, io_time, arrival_time, priority);
+    while (cursor < line_end && is_blank(*cursor)) {
+        cursor++;
+    }
+    if (cursor != line_end) {
+        if (bursts == NULL) {
+            return -1;
+        }
+        parsed = parse_burst_list(&cursor, line_end, process, bursts);
+        if (parsed != 1) {
+            return parsed == 0 ? -1 : -2;
+        }
+        while (cursor < line_end && is_blank(*cursor)) {
+            cursor++;
+        }
+        if (cursor != line_end) {
+            bursts->length = process->burst_offset;
+            return -1;
+        }
+    }
+    return 1;
+}
+
+static void report_malformed(int malformed, int line_no, const char *line, const char *line_end) {
+    if (malformed <= MAX_REPORTED_LINES) {
+        fprintf(stderr, "Malformed line %d: %.*s\n", line_no, (int) (line_end - line), line);
+    }
+}
+
+/**
+ * Parses the lines in [data, end) into the workload
+ * returns the number of malformed lines, or -1 if the arena can't grow
+ */
+static int parse_workload(Workload *workload, const char *data, const char *end) {
+    const char *line = data, *line_end;
+    int line_no = 0, malformed = 0, parsed;
+    Process process;
+
+    while (line < end) {
+        line_end = memchr(line, '\n', end - line);
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        line_no++;
+
+        parsed = parse_line(line, line_end, &process, &workload->bursts);
+        if (parsed == -1) {
+            report_malformed(++malformed, line_no, line, line_end);
+        } else if (parsed == -2 || (parsed == 1 && !append_process(workload, &process))) {
+            return -1;
+        }
+        line = line_end + 1;
+    }
+    return malformed;
+}
+
+static uint32_t get_u32(const unsigned char *bytes) {
+    return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+static uint64_t get_u64(const unsigned char *bytes) {
+    return (uint64_t) get_u32(bytes) | (uint64_t) get_u32(bytes + 4) << 32;
+}
+
+static void put_u32(unsigned char *bytes, uint32_t value) {
+    bytes[0] = value & 0xff;
+    bytes[1] = (value >> 8) & 0xff;
+    bytes[2] = (value >> 16) & 0xff;
+    bytes[3] = (value >> 24) & 0xff;
+}
+
+static void put_u64(unsigned char *bytes, uint64_t value) {
+    put_u32(bytes, (uint32_t) value);
+    put_u32(bytes + 4, (uint32_t) (value >> 32));
+}
+
+static int is_little_endian_host(void) {
+    uint32_t one = 1;
+    return *(unsigned char*) &one == 1;
+}
+
+static uint64_t fnv1a(const unsigned char *bytes, size_t size, uint64_t hash) {
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Takes the records of a mapped binary workload, either in place or copied
+ * into an arena when the host can't use them as they are
+ * returns LOAD_OK, or why the file was rejected
+ */
+static int load_binary_workload(Workload *workload, unsigned char *data, size_t size, const char *file_name) {
+    WorkloadHeader header;
+    unsigned char *records = data + WORKLOAD_HEADER_SIZE, *record;
+    int i;
+
+    header.version = get_u32(data + 8);
+    header.flags = get_u32(data + 12);
+    header.record_count = get_u64(data + 16);
+    header.record_size = get_u32(data + 24);
+    header.checksum = get_u64(data + 32);
+
+    if (header.version != WORKLOAD_VERSION || header.record_size < 4 * sizeof(uint32_t) ||
+        header.record_size % sizeof(uint32_t) != 0 || header.record_count > INT_MAX ||
+        (size - WORKLOAD_HEADER_SIZE) / header.record_size != header.record_count ||
+        (size - WORKLOAD_HEADER_SIZE) % header.record_size != 0) {
+        fprintf(stderr, "Malformed binary workload %s\n", file_name);
+        return LOAD_MALFORMED;
+    }
+    if (fnv1a(records, header.record_count * header.record_size, FNV_OFFSET_BASIS) != header.checksum) {
+        fprintf(stderr, "Checksum mismatch in binary workload %s\n", file_name);
+        return LOAD_MALFORMED;
+    }
+
+    workload->no_of_processes = workload->capacity = (int) header.record_count;
+    workload->sorted = (header.flags & WORKLOAD_SORTED) != 0;
+
+    if (is_little_endian_host() && header.record_size == sizeof(Process)) {
+        // there is no burst table to go with the records, a record that points into one is made up
+        for (i = 0; i < workload->no_of_processes; i++) {
+            Process *process = (Process*) records + i;
+            if (process->burst_offset != -1 || process->burst_count != 1) {
+                fprintf(stderr, "Malformed binary workload %s\n", file_name);
+                return LOAD_MALFORMED;
+            }
+        }
+        workload->processes = (Process*) records;
+        workload->mapping = data;
+        workload->mapping_size = size;
+        return LOAD_OK;
+    }
+
+    workload->processes = malloc(sizeof(Process) * ((size_t) workload->no_of_processes + 1));
+    INSTRUMENT_COUNT(allocations);
+    if (workload->processes == NULL) {
+        return LOAD_NO_MEMORY;
+    }
+    for (i = 0; i < workload->no_of_processes; i++) {
+        record = records + (size_t) i * header.record_size;
+        init_process(&workload->processes[i], (int) get_u32(record), (int) get_u32(record + 4),
+                     (int) get_u32(record + 8), (int) get_u32(record + 12),
+                     header.record_size >= offsetof(Process, priority) + sizeof(uint32_t) ?
+                     (int) get_u32(record + offsetof(Process, priority)) : 0);
+    }
+    return LOAD_OK;
+}
+
+/**
+ * Loads the processes info file, text or binary, into a workload
+ * returns LOAD_OK, or the reason nothing was loaded
+ */
+int load_workload(Workload *workload, const char *file_name) {
+    struct stat file_stat;
+    unsigned char *data = NULL;
+    int fd, result, i;
+
+    memset(workload, 0, sizeof(Workload));
+
+    fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        return LOAD_NOT_FOUND;
+    }
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return LOAD_NOT_FOUND;
+    }
+
+    result = LOAD_OK;
+    if (file_stat.st_size > 0) {
+        // private and writable, so a binary workload can be simulated in place
+        data = mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return LOAD_NOT_FOUND;
+        }
+        if (file_stat.st_size >= WORKLOAD_HEADER_SIZE && memcmp(data, WORKLOAD_MAGIC, 8) == 0) {
+            result = load_binary_workload(workload, data, file_stat.st_size, file_name);
+        } else {
+            madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+            result = parse_workload(workload, (const char*) data, (const char*) data + file_stat.st_size);
+            if (result > 0) {
+                fprintf(stderr, "%d malformed lines in %s\n", result, file_name);
+                result = LOAD_MALFORMED;
+            } else if (result < 0) {
+                result = LOAD_NO_MEMORY;
+            }
+        }
+        if (workload->mapping != data) {
+            munmap(data, file_stat.st_size);
+        }
+    }
+    close(fd);
+
+    if (result != LOAD_OK) {
+        free_workload(workload);
+        return result;
+    }
+
+    // the arena doesn't move anymore, point the process list into it
+    workload->process_list = malloc(sizeof(Process*) * ((size_t) workload->no_of_processes + 1));
+    INSTRUMENT_COUNT(allocations);
+    if (workload->process_list == NULL) {
+        free_workload(workload);
+        return LOAD_NO_MEMORY;
+    }
+    for (i = 0; i < workload->no_of_processes; i++) {
+        workload->process_list[i] = &workload->processes[i];
+    }
+    workload->process_list[workload->no_of_processes] = NULL;
+    return LOAD_OK;
+}
+
+/**
+ * Writes the workload's processes, in process list order, as a binary workload
+ * returns LOAD_OK, LOAD_MALFORMED if a process has a burst list, which binary
+ * workloads can't hold, or LOAD_NOT_FOUND if the file can't be written
+ */
+int save_workload(Workload *workload, const char *file_name, uint32_t flags) {
+    unsigned char header[WORKLOAD_HEADER_SIZE];
+    unsigned char record[sizeof(Process)];
+    int words[sizeof(Process) / sizeof(int)];
+    uint64_t checksum = FNV_OFFSET_BASIS;
+    Process initial;
+    size_t w;
+    int i, ok;
+
+    if (workload->bursts.length > 0) {
+        return LOAD_MALFORMED;
+    }
+    FILE *f = fopen(file_name, "wb");
+    if (f == NULL) {
+        return LOAD_NOT_FOUND;
+    }
+
+    // the header goes in last, once the checksum is known
+    memset(header, 0, sizeof(header));
+    ok = fwrite(header, sizeof(header), 1, f) == 1;
+
+    for (i = 0; ok && i < workload->no_of_processes; i++) {
+        Process *process = workload->process_list[i];
+        init_process(&initial, process->process_id, process->cpu_time, process->io_time, process->arrival_time,
+                     process->priority);
+        memcpy(words, &initial, sizeof(Process));
+        for (w = 0; w < sizeof(Process) / sizeof(int); w++) {
+            put_u32(record + w * sizeof(uint32_t), (uint32_t) words[w]);
+        }
+        checksum = fnv1a(record, sizeof(record), checksum);
+        ok = fwrite(record, sizeof(record), 1, f) == 1;
+    }
+
+    memcpy(header, WORKLOAD_MAGIC, 8);
+    put_u32(header + 8, WORKLOAD_VERSION);
+    put_u32(header + 12, flags);
+    put_u64(header + 16, (uint64_t) workload->no_of_processes);
+    put_u32(header + 24, sizeof(Process));
+    put_u32(header + 28, 0);
+    put_u64(header + 32, checksum);
+    ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(header, sizeof(header), 1, f) == 1;
+
+    if (fclose(f) != 0 || !ok) {
+        return LOAD_NOT_FOUND;
+    }
+    return LOAD_OK;
+}
+
+void free_workload(Workload *workload) {
+    free(workload->process_list);
+    if (workload->mapping != NULL) {
+        munmap(workload->mapping, workload->mapping_size);
+    } else {
+        free(workload->processes);
+    }
+    free_burst_table(&workload->bursts);
+    memset(workload, 0, sizeof(Workload));
+}
+
+/**
+ * Opens a text workload for reading one process at a time, "-" reads stdin
+ * returns LOAD_OK or LOAD_NOT_FOUND
+ */
+int open_workload_stream(WorkloadStream *stream, const char *file_name) {
+    memset(stream, 0, sizeof(WorkloadStream));
+    if (strcmp(file_name, "-") == 0) {
+        stream->in = stdin;
+    } else {
+        stream->in = fopen(file_name, "r");
+        if (stream->in == NULL) {
+            return LOAD_NOT_FOUND;
+        }
+    }
+    return LOAD_OK;
+}
+
+/**
+ * Reads the next process of the stream into process, malformed lines are
+ * reported and skipped the way load_workload does
+ * returns 1, or 0 at the end of the input
+ */
+int read_streamed_process(WorkloadStream *stream, Process *process) {
+    ssize_t length;
+    while ((length = getline(&stream->line, &stream->line_capacity, stream->in)) >= 0) {
+        const char *line_end = stream->line + length;
+        if (length > 0 && line_end[-1] == '\n') {
+            line_end--;
+        }
+        stream->line_no++;
+
+        int parsed = parse_line(stream->line, line_end, process, NULL);
+        if (parsed == 1) {
+            return 1;
+        }
+        if (parsed == -1) {
+            report_malformed(++stream->malformed, stream->line_no, stream->line, line_end);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Reads the next workload of a batch file, its processes up to the next blank
+ * line, into processes. Malformed lines are reported and skipped, a workload
+ * with more than max_processes processes is skipped as a whole
+ * returns its number of processes, 0 at the end of the input or -1 if it was
+ * skipped
+ */
+int read_batched_workload(WorkloadStream *stream, Process *processes, int max_processes) {
+    ssize_t length;
+    int count = 0;
+    while ((length = getline(&stream->line, &stream->line_capacity, stream->in)) >= 0) {
+        const char *line_end = stream->line + length;
+        if (length > 0 && line_end[-1] == '\n') {
+            line_end--;
+        }
+        stream->line_no++;
+
+        Process process;
+        int parsed = parse_line(stream->line, line_end, &process, NULL);
+        if (parsed == 1) {
+            if (count < max_processes) {
+                processes[count] = process;
+            }
+            count++;
+        } else if (parsed == -1) {
+            report_malformed(++stream->malformed, stream->line_no, stream->line, line_end);
+        } else if (count > 0) {
+            // blank lines before a workload are skipped, the first one after it ends it
+            break;
+        }
+    }
+    return count > max_processes ? -1 : count;
+}
+
+void close_workload_stream(WorkloadStream *stream) {
+    if (stream->in != NULL && stream->in != stdin) {
+        fclose(stream->in);
+    }
+    free(stream->line);
+    memset(stream, 0, sizeof(WorkloadStream));
+}
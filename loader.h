@@ -0,0 +1,72 @@
+/**
+ * Workload Loader
+ */
+
+#ifndef SCHEDULERS_LOADER_H
+#define SCHEDULERS_LOADER_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "process.h"
+#include "bursts.h"
+
+enum LoadResult {LOAD_OK = 0, LOAD_NOT_FOUND = -1, LOAD_MALFORMED = -2, LOAD_NO_MEMORY = -3};
+
+/* Binary workload files start with this header, every field little endian:
+ *   0  magic "SCHEDWL\0"
+ *   8  u32 version
+ *  12  u32 flags
+ *  16  u64 record count
+ *  24  u32 record size in bytes
+ *  28  u32 reserved, 0
+ *  32  u64 FNV-1a checksum of all the records
+ * followed by the records, each a Process in its initial state stored as
+ * little endian 32 bit words, so process_id, cpu_time, io_time and
+ * arrival_time are its first four words. Records written before priority
+ * was added end before it, their processes get priority 0.
+ */
+#define WORKLOAD_MAGIC "SCHEDWL"
+#define WORKLOAD_VERSION 1
+#define WORKLOAD_HEADER_SIZE 40
+#define WORKLOAD_SORTED 1 // records are ordered by arrival time then process id
+
+typedef struct WorkloadHeader {
+    uint32_t version;
+    uint32_t flags;
+    uint64_t record_count;
+    uint32_t record_size;
+    uint64_t checksum;
+} WorkloadHeader;
+
+typedef struct Workload {
+    Process *processes; // all records in one arena, or the mapped binary file
+    Process **process_list; // NULL terminated, points into the arena
+    int no_of_processes;
+    int capacity;
+    int sorted; // already ordered the way sort_process_list orders them
+    void *mapping; // binary file mapped in place of the arena
+    size_t mapping_size;
+    BurstTable bursts; // the burst lists of its processes, empty if none has one
+} Workload;
+
+/* a text workload read one line at a time instead of all at once, or a batch
+ * file of many text workloads, each ended by a blank line, neither with burst lists
+ */
+typedef struct WorkloadStream {
+    FILE *in;
+    char *line;
+    size_t line_capacity;
+    int line_no;
+    int malformed;
+} WorkloadStream;
+
+int load_workload(Workload *workload, const char *file_name);
+int save_workload(Workload *workload, const char *file_name, uint32_t flags);
+void free_workload(Workload *workload);
+
+int open_workload_stream(WorkloadStream *stream, const char *file_name);
+int read_streamed_process(WorkloadStream *stream, Process *process);
+int read_batched_workload(WorkloadStream *stream, Process *processes, int max_processes);
+void close_workload_stream(WorkloadStream *stream);
+
+#endif //SCHEDULERS_LOADER_H
@@ -4,83 +4,433 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
-#define MAX_PROCESS_COUNT 10
-#define DEBUG_MODE 0
-
+#include "loader.h"
+#include "scheduler.h"
+#include "stream.h"
+#include "batch.h"
+#include "checkpoint.h"
 #include "fcfs.h"
+#include "result_cache.h"
+
+// FCFS keeps its output in a file, the others print it
+static FILE* open_output(int alg_type) {
+    if (alg_type == FCFS_ALGORITHM) {
+        FILE *out = fopen("FCFS.out", "w");
+        if (out == NULL) {
+            printf("FCFS.out Could Not Be Opened");
+        }
+        return out;
+    }
+    return stdout;
+}
+
+/**
+ * Runs the processes of file_name, "-" for stdin, as they are read, with
+ * room for max_active of them in the system at once, pipelined reading and
+ * writing on threads of their own
+ */
+static void run_streamed(int alg_type, int quantum_time, char *file_name, int summary_format, int max_active,
+                         int latency_report, int pipelined) {
+    WorkloadStream input;
+    if (open_workload_stream(&input, file_name) != LOAD_OK) {
+        printf("Processes Info File Not Found");
+        return;
+    }
+    SchedulerContext context;
+    if (!init_stream_context(&context, max_active)) {
+        printf("Processes Info File Could Not Be Loaded");
+        close_workload_stream(&input);
+        return;
+    }
+    context.alg_type = alg_type;
+    context.quantum = quantum_time;
+    context.summary_format = summary_format;
+    context.latency_report = latency_report;
+    context.out = open_output(alg_type);
+    if (context.out != NULL) {
+        OutputWriter writer;
+        if (pipelined && start_output_writer(&writer, context.out)) {
+            context.writer = &writer;
+        }
+        int result = run_stream(&context, &input, pipelined);
+        if (context.writer != NULL) {
+            finish_output_writer(context.writer);
+        }
+        if (result == STREAM_FULL) {
+            printf("More Than %d Processes Active, Raise --max-active", max_active);
+        } else if (result == STREAM_UNORDERED) {
+            printf("Streamed Processes Must Be Ordered By Arrival Time, Line %d Is Not", input.line_no);
+        } else if (result == STREAM_NO_MEMORY) {
+            printf("Not Enough Memory To Run The Simulation");
+        }
+        if (context.out != stdout) {
+            fclose(context.out);
+        }
+    }
+    free_scheduler_context(&context);
+    close_workload_stream(&input);
+}
+
+/**
+ * Runs every workload of the batch file file_name, "-" for stdin, under FCFS
+ * or RR and writes their summaries one after the other
+ */
+static void run_batched(int alg_type, int quantum_time, char *file_name, int summary_format, int pipelined) {
+    if (alg_type != FCFS_ALGORITHM && alg_type != RR_ALGORITHM) {
+        printf("Batches Run Under FCFS Or RR Only");
+        return;
+    }
+    WorkloadStream input;
+    if (open_workload_stream(&input, file_name) != LOAD_OK) {
+        printf("Processes Info File Not Found");
+        return;
+    }
+    SchedulerContext context;
+    if (!init_scheduler_context(&context, NULL, 0)) {
+        printf("Processes Info File Could Not Be Loaded");
+        close_workload_stream(&input);
+        return;
+    }
+    context.alg_type = alg_type;
+    context.quantum = quantum_time;
+    context.summary_format = summary_format;
+    context.out = open_output(alg_type);
+    if (context.out != NULL) {
+        OutputWriter writer;
+        if (pipelined && start_output_writer(&writer, context.out)) {
+            context.writer = &writer;
+        }
+        int result = run_batch(&context, &input);
+        if (context.writer != NULL) {
+            finish_output_writer(context.writer);
+        }
+        if (result < 0) {
+            printf("Processes Info File Could Not Be Loaded");
+        }
+        if (context.out != stdout) {
+            fclose(context.out);
+        }
+    }
+    free_scheduler_context(&context);
+    close_workload_stream(&input);
+}
+
+/**
+ * Reads a comma separated list of quanta, one per level from the highest
+ * returns how many, or 0 if one isn't a positive number or there are too many
+ */
+static int parse_level_quanta(const char *list, int *quanta) {
+    int count = 0;
+    char *end;
+    while (count < MLFQ_MAX_LEVELS) {
+        long quantum = strtol(list, &end, 10);
+        if (end == list || quantum < 1 || quantum > INT_MAX) {
+            return 0;
+        }
+        quanta[count++] = (int) quantum;
+        if (*end == '\0') {
+            return count;
+        }
+        if (*end != ',') {
+            return 0;
+        }
+        list = end + 1;
+    }
+    return 0;
+}
 
-// args: alg_type[0, 1] quantum_time filename
+// args: alg_type[0: FCFS, 1: RR, 2: SJF, 3: SRTF, 4: priority, 5: MLFQ] quantum_time filename
+//       [--engine=event|tick|policy] [--timeline=full|delta|rle|none]
+//       [--summary[=text|csv|json]] [--cpus=N] [--host-threads=N] [--counters=json|csv]
+//       [--stream [--max-active=N]] [--latency] [--pipeline] [--batch]
+//       [--checkpoint=file [--checkpoint-every=N]] [--restore=file]
+//       [--levels=N | --level-quanta=q0,q1,...] [--boost-every=N]
+//       [--cache=directory [--cache-size=bytes]]
+// --counters picks the format of the counters report written to stderr at exit,
+// which is only there when built with -DINSTRUMENT=1
+// --stream reads the file, "-" for stdin, as the simulation reaches each arrival and
+// writes turnarounds as processes finish, on the policy engine with no timeline
+// --latency adds the mean and percentiles of waiting, response and turnaround times
+// --pipeline writes the output on a thread of its own while the simulation goes on,
+// with --stream the input is also read ahead on another thread
+// --batch runs every workload of the file, each ended by a blank line, under FCFS or RR
+// and writes a summary for each, the workloads side by side in lanes
+// a file with burst lists (see loader.c) runs under any algorithm on any engine but --stream and --batch
+// --checkpoint saves the state of an RR run to a file every --checkpoint-every ticks and
+// --restore goes on from such a file, both on the tick engine
+// MLFQ runs on one cpu with --levels levels, quantum_time at the highest and doubling
+// each level down, or with the quanta of --level-quanta, all processes moved back to
+// the highest level every --boost-every ticks
+// --cache keeps the output of runs in a directory and writes it from there when the
+// same workload is run with the same arguments again, without loading or simulating
+// it, the results used longest ago removed once they take more than --cache-size,
+// see tools/cache_admin to verify or purge a cache
 int main(int argc, char* argv[]) {
 
     // extract running arguments
-    if (argc != 4) {
+    if (argc < 4) {
         printf("Invalid executing arguments");
         return 0;
     }
     int alg_type = atoi(argv[1]);
+    // any other alg_type has always meant RR
+    if (alg_type < FCFS_ALGORITHM || alg_type > MLFQ_ALGORITHM) {
+        alg_type = RR_ALGORITHM;
+    }
     int quantum_time = atoi(argv[2]);
     char* file_name = argv[3];
 
-    if (DEBUG_MODE) {
-        printf("%d %d %s \n", alg_type, quantum_time, file_name);
+    // the event driven engine is the default, the tick engine is kept as reference
+    int engine = EVENT_ENGINE;
+    // full timelines by default, delta and rle ones can be expanded with tools/timeline_decode
+    int timeline_mode = TIMELINE_FULL;
+    // --summary[=format] skips the timeline and prints the summary block only
+    int summary_format = SUMMARY_TEXT;
+    // more than one cpu runs on the policy engine with per cpu queues, --host-threads spreads the
+    // cpus over threads to check the output stays the same, it does not make the run faster
+    int no_of_cpus = 1, host_threads = 1;
+    int counters_format = SUMMARY_JSON;
+    int stream = 0, max_active = DEFAULT_MAX_ACTIVE;
+    int latency_report = 0;
+    int pipelined = 0;
+    int batch = 0;
+    const char *checkpoint_file = NULL, *restore_file = NULL;
+    int checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+    int levels = DEFAULT_MLFQ_LEVELS, boost_interval = 0;
+    int level_quanta[MLFQ_MAX_LEVELS];
+    int has_level_quanta = 0;
+    const char *cache_directory = NULL;
+    long long cache_size = DEFAULT_CACHE_SIZE;
+    int arg;
+    for (arg = 4; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--engine=tick") == 0) {
+            engine = TICK_ENGINE;
+        } else if (strcmp(argv[arg], "--engine=event") == 0) {
+            engine = EVENT_ENGINE;
+        } else if (strcmp(argv[arg], "--engine=policy") == 0) {
+            engine = POLICY_ENGINE;
+        } else if (strcmp(argv[arg], "--timeline=full") == 0) {
+            timeline_mode = TIMELINE_FULL;
+        } else if (strcmp(argv[arg], "--timeline=delta") == 0) {
+            timeline_mode = TIMELINE_DELTA;
+        } else if (strcmp(argv[arg], "--timeline=rle") == 0) {
+            timeline_mode = TIMELINE_RUN_LENGTH;
+        } else if (strcmp(argv[arg], "--timeline=none") == 0) {
+            timeline_mode = TIMELINE_NONE;
+        } else if (strcmp(argv[arg], "--summary") == 0 || strcmp(argv[arg], "--summary=text") == 0) {
+            timeline_mode = TIMELINE_NONE;
+            summary_format = SUMMARY_TEXT;
+        } else if (strcmp(argv[arg], "--summary=csv") == 0) {
+            timeline_mode = TIMELINE_NONE;
+            summary_format = SUMMARY_CSV;
+        } else if (strcmp(argv[arg], "--summary=json") == 0) {
+            timeline_mode = TIMELINE_NONE;
+            summary_format = SUMMARY_JSON;
+        } else if (strncmp(argv[arg], "--cpus=", 7) == 0 && atoi(argv[arg] + 7) > 0) {
+            no_of_cpus = atoi(argv[arg] + 7);
+        } else if (strncmp(argv[arg], "--host-threads=", 15) == 0 && atoi(argv[arg] + 15) > 0) {
+            host_threads = atoi(argv[arg] + 15);
+        } else if (strcmp(argv[arg], "--counters=json") == 0) {
+            counters_format = SUMMARY_JSON;
+        } else if (strcmp(argv[arg], "--counters=csv") == 0) {
+            counters_format = SUMMARY_CSV;
+        } else if (strcmp(argv[arg], "--stream") == 0) {
+            stream = 1;
+        } else if (strncmp(argv[arg], "--max-active=", 13) == 0 && atoi(argv[arg] + 13) > 0) {
+            max_active = atoi(argv[arg] + 13);
+        } else if (strcmp(argv[arg], "--latency") == 0) {
+            latency_report = 1;
+        } else if (strcmp(argv[arg], "--pipeline") == 0) {
+            pipelined = 1;
+        } else if (strcmp(argv[arg], "--batch") == 0) {
+            batch = 1;
+        } else if (strncmp(argv[arg], "--checkpoint=", 13) == 0 && argv[arg][13] != '\0') {
+            checkpoint_file = argv[arg] + 13;
+        } else if (strncmp(argv[arg], "--checkpoint-every=", 19) == 0 && atoi(argv[arg] + 19) > 0) {
+            checkpoint_interval = atoi(argv[arg] + 19);
+        } else if (strncmp(argv[arg], "--restore=", 10) == 0 && argv[arg][10] != '\0') {
+            restore_file = argv[arg] + 10;
+        } else if (strncmp(argv[arg], "--levels=", 9) == 0 && atoi(argv[arg] + 9) > 0 &&
+                   atoi(argv[arg] + 9) <= MLFQ_MAX_LEVELS) {
+            levels = atoi(argv[arg] + 9);
+            has_level_quanta = 0;
+        } else if (strncmp(argv[arg], "--level-quanta=", 15) == 0 &&
+                   parse_level_quanta(argv[arg] + 15, level_quanta) > 0) {
+            levels = parse_level_quanta(argv[arg] + 15, level_quanta);
+            has_level_quanta = 1;
+        } else if (strncmp(argv[arg], "--boost-every=", 14) == 0 && atoi(argv[arg] + 14) > 0) {
+            boost_interval = atoi(argv[arg] + 14);
+        } else if (strncmp(argv[arg], "--cache=", 8) == 0 && argv[arg][8] != '\0') {
+            cache_directory = argv[arg] + 8;
+        } else if (strncmp(argv[arg], "--cache-size=", 13) == 0 && atoll(argv[arg] + 13) > 0) {
+            cache_size = atoll(argv[arg] + 13);
+        } else {
+            printf("Invalid executing arguments");
+            return 0;
+        }
+    }
+
+    if ((checkpoint_file != NULL || restore_file != NULL) &&
+        (alg_type != RR_ALGORITHM || no_of_cpus > 1 || batch || stream)) {
+        printf("Checkpoints Are Taken Under RR On One CPU Only");
+        return 0;
+    }
+    if (alg_type == MLFQ_ALGORITHM && (no_of_cpus > 1 || stream)) {
+        printf("MLFQ Runs On One CPU Only");
+        return 0;
+    }
+    if (cache_directory != NULL && (batch || stream || checkpoint_file != NULL || restore_file != NULL)) {
+        printf("Streamed, Batched And Checkpointed Runs Are Not Cached");
+        return 0;
+    }
+    if (batch) {
+        run_batched(alg_type, quantum_time, file_name, summary_format, pipelined);
+        INSTRUMENT_REPORT(stderr, counters_format);
+        return 0;
+    }
+    if (stream) {
+        run_streamed(alg_type, quantum_time, file_name, summary_format, max_active, latency_report, pipelined);
+        INSTRUMENT_REPORT(stderr, counters_format);
+        return 0;
+    }
+
+    // a run already in the cache is written from there, the workload isn't even loaded
+    ResultCache cache = {cache_directory, cache_size};
+    uint64_t cache_key = 0;
+    int cached = 0;
+    if (cache_directory != NULL) {
+        // everything the output depends on besides the workload
+        int parameters[11 + MLFQ_MAX_LEVELS] = {alg_type, quantum_time, engine, timeline_mode, summary_format,
+                                                no_of_cpus, host_threads, latency_report, levels, boost_interval,
+                                                has_level_quanta};
+        int parameter_count = 11;
+        if (has_level_quanta) {
+            memcpy(parameters + parameter_count, level_quanta, sizeof(int) * levels);
+            parameter_count += levels;
+        }
+        cached = result_cache_key(file_name, parameters, parameter_count, &cache_key);
+    }
+    if (cached) {
+        CachedResult found;
+        FILE *out = open_output(alg_type);
+        if (out == NULL) {
+            return 0;
+        }
+        int hit = find_cached_result(&cache, cache_key, &found, out);
+        if (out != stdout) {
+            fclose(out);
+        }
+        if (hit == 1) {
+            INSTRUMENT_REPORT(stderr, counters_format);
+            return 0;
+        }
     }
 
     // read processes data from the input file
-    FILE *input_file = fopen(file_name, "r");
-    if (input_file == NULL) {
+    Workload workload;
+    INSTRUMENT_BEGIN(LOAD_TIMING);
+    int load_result = load_workload(&workload, file_name);
+    INSTRUMENT_END(LOAD_TIMING);
+    if (load_result == LOAD_NOT_FOUND) {
         printf("Processes Info File Not Found");
         return 0;
+    } else if (load_result != LOAD_OK) {
+        printf("Processes Info File Could Not Be Loaded");
+        return 0;
     }
 
-    Process **process_list = malloc(sizeof(Process) * MAX_PROCESS_COUNT);
-    Process *new_process;
-    int no_of_processes = 0;
-    int process_id, cpu_time, io_time, arrival_time;
-
-    while((fscanf(input_file, "%d %d %d %d", &process_id, &cpu_time, &io_time, &arrival_time)) == 4) {
-        new_process = malloc(sizeof(Process));
-        new_process->process_id = process_id;
-        new_process->cpu_time = cpu_time;
-        new_process->io_time = io_time;
-        new_process->arrival_time = arrival_time;
-        new_process->status = 4;
-        new_process->spent_cpu_time = 0;
-        new_process->spent_io_time = 0;
+    Process **process_list = workload.process_list;
+    int no_of_processes = workload.no_of_processes;
+    // run the scheduler alg. based on the argument given
+    INSTRUMENT_BEGIN(SORT_TIMING);
+    if (!workload.sorted) {
+        sort_process_list(process_list, no_of_processes);
+    }
+    INSTRUMENT_END(SORT_TIMING);
+    SchedulerContext context;
+    if (!init_scheduler_context(&context, process_list, no_of_processes)) {
+        printf("Processes Info File Could Not Be Loaded");
+        free_workload(&workload);
+        return 0;
+    }
+    context.alg_type = alg_type;
+    context.quantum = quantum_time;
+    context.engine = engine;
+    context.timeline_mode = timeline_mode;
+    context.summary_format = summary_format;
+    context.no_of_cpus = no_of_cpus;
+    context.host_threads = host_threads;
+    context.latency_report = latency_report;
+    context.checkpoint_file = checkpoint_file;
+    context.checkpoint_interval = checkpoint_interval;
+    context.restore_file = restore_file;
+    context.levels = levels;
+    if (has_level_quanta) {
+        context.level_quanta = level_quanta;
+    }
+    context.boost_interval = boost_interval;
+    if (workload.bursts.length > 0) {
+        context.bursts = workload.bursts.bytes;
+    }
+    context.out = open_output(alg_type);
+    if (context.out == NULL) {
+        free_scheduler_context(&context);
+        free_workload(&workload);
+        return 0;
+    }
 
-        if (DEBUG_MODE) {
-            printf("DEBUG: Process: %d %d %d %d\n", process_id, cpu_time, io_time, arrival_time);
-            printf("DEBUG: struct Process: %d %d %d %d\n", new_process->process_id, new_process->cpu_time,
-                   new_process->io_time, new_process->arrival_time);
+    // the output of a run to cache is collected in memory first, a full timeline run length encoded
+    FILE *out = context.out;
+    char *output = NULL;
+    size_t output_length = 0;
+    CachedResult run = {0, 0, 0, 0, 0};
+    if (cached) {
+        context.out = open_memstream(&output, &output_length);
+        if (context.out == NULL) {
+            context.out = out;
+            cached = 0;
+        } else if (context.timeline_mode == TIMELINE_FULL) {
+            context.timeline_mode = TIMELINE_RUN_LENGTH;
+            run.flags = CACHED_RUN_LENGTH;
         }
-
-        process_list[no_of_processes++] = new_process;
     }
 
-    // reallocating to avoid wasted space
-    process_list = realloc(process_list, no_of_processes * sizeof(Process));
-    process_list[no_of_processes] = NULL;
-    if (DEBUG_MODE) {
-        printf("DEBUG: No. of Process %d\n", no_of_processes);
-        // print the list of process ids after reading
-        Process *current_process = *process_list;
-        int count = 0;
-        while(current_process != NULL) {
-            printf("Debug: Process ID: %d\n", current_process->process_id);
-            current_process = process_list[++count];
+    OutputWriter writer;
+    if (pipelined && start_output_writer(&writer, context.out)) {
+        context.writer = &writer;
+    }
+    int result = run_scheduler(&context);
+    if (context.writer != NULL) {
+        finish_output_writer(context.writer);
+    }
+    if (cached) {
+        fclose(context.out);
+        context.out = out;
+        run.finishing_time = context.finishing_time;
+        run.max_turnaround = context.max_turnaround;
+        run.cpu_utilization = context.cpu_utilization;
+        run.average_turnaround = context.average_turnaround;
+        if (result == 0) {
+            save_cached_result(&cache, cache_key, &run, output, output_length);
         }
+        write_cached_output(&run, output, output_length, out);
+        free(output);
     }
-
-    // close the input file
-    fclose(input_file);
-
-    // run the scheduler alg. based on the argument given
-    sort_process_list(process_list, no_of_processes);
-    if (alg_type == 0) {
-        run_fcfs(process_list, no_of_processes);
-    } else {
-        rrr(process_list, no_of_processes,quantum_time);
+    if (result == RUN_NO_MEMORY) {
+        printf("Not Enough Memory To Run The Simulation");
+    } else if (result == CHECKPOINT_NOT_FOUND) {
+        printf("Checkpoint File Not Found");
+    } else if (result < 0) {
+        printf("Checkpoint Could Not Be Restored");
     }
 
+    if (context.out != stdout) {
+        fclose(context.out);
+    }
+    free_scheduler_context(&context);
+    free_workload(&workload);
+    INSTRUMENT_REPORT(stderr, counters_format);
     return 0;
 }
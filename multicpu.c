@@ -0,0 +1,441 @@
+/**
+ * Multi CPU Engine
+ *
+ * The policy engine's tick loop spread over no_of_cpus cpus, each with its
+ * own ready queue. An arriving process goes to the least loaded cpu, a woken
+ * one back to the cpu it last ran on, and a cpu that finds its queue empty
+ * steals the best process of the busiest other cpu.
+ *
+ * Every tick runs in four phases: the cpus advance their running process,
+ * the io and arrival bookkeeping is done, the cpus pick what runs next from
+ * their own queue, then the idle cpus steal. The two per cpu phases only
+ * touch their own cpu and its processes so they can be split over
+ * host_threads threads, the other two run on one thread in cpu order. The
+ * scheduling events of a per cpu phase are kept by each cpu and emitted on
+ * the calling thread in cpu order once the phase is done, so the timeline,
+ * the summary and the events are the same whatever the number of threads.
+ *
+ * Splitting is there to check that determinism, not to go faster: a cpu's
+ * share of a tick is a few queue operations, far less than the two barrier
+ * waits each per cpu phase costs, so more threads do not make a run faster.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "multicpu.h"
+
+enum CpuPhase {ADVANCE_PHASE, PICK_PHASE, DONE_PHASE};
+
+typedef struct MultiCpuRun {
+    SchedulerContext *context;
+    const Policy *policy;
+    Cpu *cpus;
+    int no_of_cpus;
+    int *home; // per process slot, the cpu it last ran on or -1
+    int tick;
+    int phase;
+    // host threads wait for started before running any phase
+    int no_of_threads;
+    int started;
+    pthread_mutex_t lock;
+    pthread_cond_t go;
+    pthread_barrier_t phase_start;
+    pthread_barrier_t phase_end;
+} MultiCpuRun;
+
+// the cpus [first, last) one host thread runs the per cpu phases for
+typedef struct CpuRange {
+    MultiCpuRun *run;
+    int first;
+    int last;
+} CpuRange;
+
+// set_status for the per cpu phases, the event waits in the cpu for emit_cpu_events
+static void set_cpu_status(MultiCpuRun *run, Cpu *cpu, Process *process, int status) {
+    SchedulerContext *context = run->context;
+    if (context->events != NULL && status != process->status) {
+        int type = status_event_type(process, status);
+        if (type != -1) {
+            SchedEvent *event = &cpu->events[cpu->event_count++];
+            event->tick = run->tick;
+            event->type = type;
+            event->process_id = process->process_id;
+            event->slot = (int) (process - context->processes);
+        }
+    }
+    change_status(context, process, status);
+}
+
+static void emit_cpu_events(MultiCpuRun *run) {
+    int c, i;
+    if (run->context->events == NULL) {
+        return;
+    }
+    for (c = 0; c < run->no_of_cpus; c++) {
+        Cpu *cpu = &run->cpus[c];
+        for (i = 0; i < cpu->event_count; i++) {
+            SchedEvent *event = &cpu->events[i];
+            emit_event(run->context->events, event->tick, event->type, event->process_id, event->slot);
+        }
+        cpu->event_count = 0;
+    }
+}
+
+static void advance_cpus(MultiCpuRun *run, int first, int last) {
+    int c;
+    for (c = first; c < last; c++) {
+        Cpu *cpu = &run->cpus[c];
+        Process *running = cpu->running;
+        cpu->event = CPU_NO_EVENT;
+        if (running == NULL) {
+            continue;
+        }
+        cpu->run_time++;
+        switch (run_burst_tick(run->context->bursts, running)) {
+            case BURST_TERMINATES:
+                set_cpu_status(run, cpu, running, TERMINATED);
+                running->turnaround = run->tick - running->turnaround;
+                cpu->event = CPU_TERMINATED;
+                break;
+            case BURST_BLOCKS:
+                set_cpu_status(run, cpu, running, BLOCKING);
+                cpu->event = CPU_BLOCKED;
+                break;
+            default:
+                continue;
+        }
+        cpu->left = running;
+        cpu->running = NULL;
+    }
+}
+
+static void start_running(MultiCpuRun *run, int c, Process *process) {
+    Cpu *cpu = &run->cpus[c];
+    set_cpu_status(run, cpu, process, RUNNING);
+    cpu->running = process;
+    cpu->run_time = 0;
+    run->home[process - run->context->processes] = c;
+}
+
+static void pick_cpus(MultiCpuRun *run, int first, int last) {
+    const Policy *policy = run->policy;
+    int c;
+    for (c = first; c < last; c++) {
+        Cpu *cpu = &run->cpus[c];
+        if (cpu->running != NULL && policy->should_preempt != NULL &&
+            policy->should_preempt(&cpu->queue, cpu->running, cpu->run_time)) {
+            set_cpu_status(run, cpu, cpu->running, READY);
+            policy->insert(&cpu->queue, cpu->running);
+            cpu->running = NULL;
+            INSTRUMENT_COUNT(preemptions);
+        }
+        if (cpu->running == NULL) {
+            Process *next = policy->pick_next(&cpu->queue);
+            if (next != NULL) {
+                start_running(run, c, next);
+            }
+        }
+    }
+}
+
+static void run_phase(MultiCpuRun *run, int first, int last) {
+    if (run->phase == ADVANCE_PHASE) {
+        advance_cpus(run, first, last);
+    } else if (run->phase == PICK_PHASE) {
+        pick_cpus(run, first, last);
+    }
+}
+
+static void* cpu_worker(void *arg) {
+    CpuRange *range = arg;
+    MultiCpuRun *run = range->run;
+
+    pthread_mutex_lock(&run->lock);
+    while (!run->started) {
+        pthread_cond_wait(&run->go, &run->lock);
+    }
+    pthread_mutex_unlock(&run->lock);
+
+    while (1) {
+        pthread_barrier_wait(&run->phase_start);
+        if (run->phase == DONE_PHASE) {
+            break;
+        }
+        run_phase(run, range->first, range->last);
+        pthread_barrier_wait(&run->phase_end);
+    }
+    INSTRUMENT_MERGE_THREAD();
+    return NULL;
+}
+
+// runs a per cpu phase on every host thread, the calling thread taking the first range and emitting the events
+static void run_parallel(MultiCpuRun *run, CpuRange *ranges, int phase) {
+    run->phase = phase;
+    if (run->no_of_threads > 1) {
+        pthread_barrier_wait(&run->phase_start);
+    }
+    run_phase(run, ranges[0].first, ranges[0].last);
+    if (run->no_of_threads > 1) {
+        pthread_barrier_wait(&run->phase_end);
+    }
+    emit_cpu_events(run);
+}
+
+/**
+ * Starts up to no_of_threads - 1 host threads next to the calling one and
+ * splits the cpus between all of them
+ * returns the number of threads running the phases, the calling one included
+ */
+static int start_host_threads(MultiCpuRun *run, pthread_t *threads, CpuRange *ranges, int no_of_threads) {
+    int started = 1, i;
+
+    pthread_mutex_init(&run->lock, NULL);
+    pthread_cond_init(&run->go, NULL);
+    run->started = 0;
+    ranges[0].run = run;
+    for (i = 1; i < no_of_threads; i++) {
+        ranges[started].run = run;
+        if (pthread_create(&threads[started - 1], NULL, cpu_worker, &ranges[started]) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    // the ranges are only settled once it is known how many threads there are
+    for (i = 0; i < started; i++) {
+        ranges[i].first = (int) ((long) run->no_of_cpus * i / started);
+        ranges[i].last = (int) ((long) run->no_of_cpus * (i + 1) / started);
+    }
+    run->no_of_threads = started;
+    if (started > 1) {
+        pthread_barrier_init(&run->phase_start, NULL, started);
+        pthread_barrier_init(&run->phase_end, NULL, started);
+    }
+
+    pthread_mutex_lock(&run->lock);
+    run->started = 1;
+    pthread_cond_broadcast(&run->go);
+    pthread_mutex_unlock(&run->lock);
+    return started;
+}
+
+static void stop_host_threads(MultiCpuRun *run, pthread_t *threads) {
+    int i;
+    if (run->no_of_threads > 1) {
+        run->phase = DONE_PHASE;
+        pthread_barrier_wait(&run->phase_start);
+        for (i = 0; i < run->no_of_threads - 1; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        pthread_barrier_destroy(&run->phase_start);
+        pthread_barrier_destroy(&run->phase_end);
+    }
+    pthread_cond_destroy(&run->go);
+    pthread_mutex_destroy(&run->lock);
+}
+
+// the cpu with the fewest processes, running one included, the first one on a tie
+static int least_loaded_cpu(MultiCpuRun *run) {
+    int best = 0, best_load = -1, c;
+    for (c = 0; c < run->no_of_cpus; c++) {
+        int load = ready_queue_length(&run->cpus[c].queue) + (run->cpus[c].running != NULL);
+        if (best_load == -1 || load < best_load) {
+            best = c;
+            best_load = load;
+        }
+    }
+    return best;
+}
+
+// the cpu with the longest ready queue, the first one on a tie, or -1 if all are empty
+static int busiest_cpu(MultiCpuRun *run) {
+    int best = -1, best_length = 0, c;
+    for (c = 0; c < run->no_of_cpus; c++) {
+        int length = ready_queue_length(&run->cpus[c].queue);
+        if (length > best_length) {
+            best = c;
+            best_length = length;
+        }
+    }
+    return best;
+}
+
+/**
+ * Every cpu still idle after picking takes the next process of the busiest cpu
+ * returns the number of cpus running a process
+ */
+static int steal_work(MultiCpuRun *run) {
+    int queued = 0, running_count = 0, c;
+    for (c = 0; c < run->no_of_cpus; c++) {
+        queued += ready_queue_length(&run->cpus[c].queue);
+    }
+    for (c = 0; c < run->no_of_cpus; c++) {
+        Cpu *cpu = &run->cpus[c];
+        if (cpu->running == NULL && queued > 0) {
+            int victim = busiest_cpu(run);
+            start_running(run, c, run->policy->pick_next(&run->cpus[victim].queue));
+            cpu->migrations++;
+            queued--;
+        }
+        if (cpu->running != NULL) {
+            running_count++;
+        } else {
+            cpu->not_utilized_count++;
+            INSTRUMENT_COUNT(idle_ticks);
+        }
+    }
+    emit_cpu_events(run);
+    return running_count;
+}
+
+/**
+ * Writes the summary of a run that stopped before tick, with every cpu's
+ * utilization and migrations, and the turnarounds
+ */
+static void report_cpus(MultiCpuRun *run, Timeline *timeline, int tick) {
+    SchedulerContext *context = run->context;
+    double utilization = 0;
+    int c;
+    tick -= 2;
+    for (c = 0; c < run->no_of_cpus; c++) {
+        utilization += ((tick - (run->cpus[c].not_utilized_count - 1)) * 1.0) / tick;
+    }
+    report_summary(context, timeline, tick, utilization / run->no_of_cpus);
+
+    context->migrations = 0;
+    for (c = 0; c < run->no_of_cpus; c++) {
+        Cpu *cpu = &run->cpus[c];
+        timeline_cpu(timeline, c, ((tick - (cpu->not_utilized_count - 1)) * 1.0) / tick, cpu->migrations);
+        context->migrations += cpu->migrations;
+    }
+    report_turnarounds(context, timeline);
+}
+
+/**
+ * Runs the context's processes under the policy on context->no_of_cpus cpus,
+ * the timeline is written the way run_policy writes it and the summary adds
+ * every cpu's utilization and migrations
+ * returns RUN_OK, or RUN_NO_MEMORY if there is not enough memory for the run
+ */
+int run_multi_cpu(SchedulerContext *context, const Policy *policy) {
+    Process **process_list = context->process_list;
+    int no_of_processes = context->no_of_processes;
+    int no_of_cpus = context->no_of_cpus;
+    Timeline timeline;
+    timeline_init(&timeline, context->out, FCFS_TIMELINE, context->timeline_mode, context->summary_format,
+                  process_list, context->status, no_of_processes);
+    timeline.writer = context->writer;
+    subscribe_timeline(context, &timeline);
+
+    MultiCpuRun run;
+    run.context = context;
+    run.policy = policy;
+    run.no_of_cpus = no_of_cpus;
+    run.cpus = calloc(no_of_cpus, sizeof(Cpu));
+    run.home = malloc(sizeof(int) * (no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 2);
+    run.tick = 0;
+    run.phase = ADVANCE_PHASE;
+
+    int i, c;
+    int allocated = run.cpus != NULL && run.home != NULL;
+    for (c = 0; allocated && c < no_of_cpus; c++) {
+        // the queues grow if a cpu ends up with more than its share
+        allocated &= init_ready_queue(&run.cpus[c].queue, no_of_processes / no_of_cpus + 1, context->quantum);
+    }
+    for (i = 0; run.home != NULL && i < no_of_processes; i++) {
+        run.home[i] = -1;
+    }
+
+    int no_of_threads = context->host_threads < no_of_cpus ? context->host_threads : no_of_cpus;
+    if (no_of_threads < 1) {
+        no_of_threads = 1;
+    }
+    pthread_t *threads = malloc(sizeof(pthread_t) * no_of_threads);
+    CpuRange *ranges = malloc(sizeof(CpuRange) * no_of_threads);
+    INSTRUMENT_ADD(allocations, 2);
+
+    ArrivalIndex arrivals;
+    allocated &= build_arrival_index(&arrivals, process_list, no_of_processes);
+
+    BlockedSet blocked;
+    allocated &= init_blocked_set(&blocked, no_of_processes);
+
+    Process **to_be_enqued = malloc(sizeof(Process*) * (no_of_processes + 1));
+    Process **woken = malloc(sizeof(Process*) * (no_of_processes + 1));
+    Process **ready = malloc(sizeof(Process*) * (no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 3);
+    int to_be_enqued_count, woken_count, ready_count;
+    int result = allocated && threads != NULL && ranges != NULL && to_be_enqued != NULL && woken != NULL &&
+                 ready != NULL ? RUN_OK : RUN_NO_MEMORY;
+    int started = result == RUN_OK;
+    if (started) {
+        start_host_threads(&run, threads, ranges, no_of_threads);
+    }
+
+    int terminated_count = 0, running_count;
+    int tick = 0;
+
+    while (result == RUN_OK && terminated_count != no_of_processes) {
+        context->now = tick;
+        run.tick = tick;
+        run_parallel(&run, ranges, ADVANCE_PHASE);
+
+        to_be_enqued_count = admit_arrivals(context, &arrivals, to_be_enqued, tick);
+        woken_count = wake_processes(context, &blocked, woken, tick);
+        for (c = 0; c < no_of_cpus; c++) {
+            if (run.cpus[c].event == CPU_TERMINATED) {
+                terminated_count++;
+            } else if (run.cpus[c].event == CPU_BLOCKED) {
+                wait_for_io(&blocked, run.cpus[c].left, tick);
+            }
+        }
+
+        // processes that never ran are arrivals, the rest go back to their cpu
+        ready_count = merge_processes_by_id(ready, to_be_enqued, to_be_enqued_count, woken, woken_count);
+        for (i = 0; i < ready_count; i++) {
+            int home = run.home[ready[i] - context->processes];
+            policy->insert(&run.cpus[home >= 0 ? home : least_loaded_cpu(&run)].queue, ready[i]);
+        }
+
+        INSTRUMENT_BEGIN(DISPATCH_TIMING);
+        run_parallel(&run, ranges, PICK_PHASE);
+        running_count = steal_work(&run);
+        INSTRUMENT_END(DISPATCH_TIMING);
+        for (c = 0; c < no_of_cpus; c++) {
+            if (run.cpus[c].queue.no_memory) {
+                result = RUN_NO_MEMORY;
+            }
+        }
+
+        timeline_tick(&timeline, tick);
+        tick++;
+
+        // with every cpu idle all queues are empty, anything queued would have been picked or stolen
+        if (running_count == 0 && blocked.count == 0 && next_arrival_time(&arrivals) == -1) {
+            break;
+        }
+    }
+    if (started) {
+        stop_host_threads(&run, threads);
+    }
+    if (result == RUN_OK) {
+        report_cpus(&run, &timeline, tick);
+    } else {
+        timeline_finish(&timeline);
+    }
+
+    for (c = 0; run.cpus != NULL && c < no_of_cpus; c++) {
+        free_ready_queue(&run.cpus[c].queue);
+    }
+    free(run.cpus);
+    free(run.home);
+    free(threads);
+    free(ranges);
+    free_blocked_set(&blocked);
+    free_arrival_index(&arrivals);
+    free(to_be_enqued);
+    free(woken);
+    free(ready);
+    return result;
+}
@@ -0,0 +1,29 @@
+/**
+ * Multi CPU Engine
+ */
+
+#ifndef SCHEDULERS_MULTICPU_H
+#define SCHEDULERS_MULTICPU_H
+#include "policy.h"
+
+enum CpuEvent {CPU_NO_EVENT, CPU_TERMINATED, CPU_BLOCKED};
+// the most scheduling events one cpu has in a phase, a preemption and a dispatch
+#define CPU_PHASE_EVENTS 2
+
+// one simulated cpu, with its own ready queue under the run's policy
+typedef struct Cpu {
+    ReadyQueue queue;
+    Process *running;
+    int run_time; // ticks since running was picked
+    int not_utilized_count;
+    int migrations; // processes this cpu stole from another one
+    int event; // what happened to left at the current tick
+    Process *left;
+    // the scheduling events of the phase running, emitted in cpu order once it is done
+    SchedEvent events[CPU_PHASE_EVENTS];
+    int event_count;
+} Cpu;
+
+int run_multi_cpu(SchedulerContext *context, const Policy *policy);
+
+#endif //SCHEDULERS_MULTICPU_H
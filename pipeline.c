@@ -0,0 +1,190 @@
+/**
+ * Pipeline Stages
+ *
+ * What lets reading, simulating and writing run on threads of their own: a
+ * single producer single consumer ring to hand records from one stage to the
+ * next, and the output stage, a thread that writes the timeline's buffers
+ * while the simulation fills the next one. The parsing stage is in stream.c.
+ *
+ * A side that finds the ring full or empty spins for a while, then yields,
+ * then sleeps, so a stage that is ahead doesn't keep a core from the others.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include "pipeline.h"
+#include "instrument.h"
+
+#define SPINS_BEFORE_YIELD 64
+#define YIELDS_BEFORE_SLEEP 256
+
+static void wait_a_little(int *waited) {
+    if (*waited < SPINS_BEFORE_YIELD) {
+        // just look again
+    } else if (*waited < SPINS_BEFORE_YIELD + YIELDS_BEFORE_SLEEP) {
+        sched_yield();
+    } else {
+        struct timespec pause = {0, 50000};
+        nanosleep(&pause, NULL);
+    }
+    (*waited)++;
+}
+
+/**
+ * returns 1, or 0 if there is not enough memory
+ */
+int init_spsc_ring(SpscRing *ring, int capacity, size_t slot_size) {
+    unsigned int size = 1;
+    while (size < (unsigned int) capacity) {
+        size <<= 1;
+    }
+    ring->slots = malloc(slot_size * size);
+    INSTRUMENT_COUNT(allocations);
+    if (ring->slots == NULL) {
+        return 0;
+    }
+    ring->slot_size = slot_size;
+    ring->mask = size - 1;
+    ring->tail = ring->cached_head = 0;
+    ring->head = ring->cached_tail = 0;
+    ring->closed = ring->abandoned = 0;
+    return 1;
+}
+
+void free_spsc_ring(SpscRing *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/**
+ * Copies item into the ring, waiting while it is full
+ * returns 1, or 0 if the consumer abandoned the ring and the item was dropped
+ */
+int spsc_push(SpscRing *ring, const void *item) {
+    unsigned int tail = ring->tail;
+    int waited = 0;
+    while (tail - ring->cached_head > ring->mask) {
+        if (__atomic_load_n(&ring->abandoned, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+        wait_a_little(&waited);
+        ring->cached_head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    }
+    memcpy(ring->slots + (tail & ring->mask) * ring->slot_size, item, ring->slot_size);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    INSTRUMENT_COUNT(queue_ops);
+    return 1;
+}
+
+/**
+ * Copies the oldest item out of the ring into item, waiting while it is empty
+ * returns 1, or 0 once the producer closed the ring and it is empty
+ */
+int spsc_pop(SpscRing *ring, void *item) {
+    unsigned int head = ring->head;
+    int waited = 0;
+    while (head == ring->cached_tail) {
+        ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head != ring->cached_tail) {
+            break;
+        }
+        // the tail is read again after closed, an item pushed just before closing isn't lost
+        if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE)) {
+            ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+            if (head == ring->cached_tail) {
+                return 0;
+            }
+            break;
+        }
+        wait_a_little(&waited);
+    }
+    memcpy(item, ring->slots + (head & ring->mask) * ring->slot_size, ring->slot_size);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    INSTRUMENT_COUNT(queue_ops);
+    return 1;
+}
+
+/**
+ * Copies the oldest item out of the ring into item if there is one, without waiting
+ * returns 1, 0 if the ring is empty for now or -1 once the producer closed it and it is empty
+ */
+int spsc_try_pop(SpscRing *ring, void *item) {
+    unsigned int head = ring->head;
+    if (head == ring->cached_tail) {
+        int closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+        ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head == ring->cached_tail) {
+            return closed ? -1 : 0;
+        }
+    }
+    memcpy(item, ring->slots + (head & ring->mask) * ring->slot_size, ring->slot_size);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    INSTRUMENT_COUNT(queue_ops);
+    return 1;
+}
+
+// called by the producer after its last push
+void spsc_close(SpscRing *ring) {
+    __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+}
+
+// called by the consumer when it stops popping early, so the producer doesn't wait on it forever
+void spsc_abandon(SpscRing *ring) {
+    __atomic_store_n(&ring->abandoned, 1, __ATOMIC_RELEASE);
+}
+
+typedef struct OutputChunk {
+    char *data;
+    size_t length;
+} OutputChunk;
+
+static void* output_writer_thread(void *arg) {
+    OutputWriter *writer = arg;
+    OutputChunk chunk;
+    while (spsc_pop(&writer->chunks, &chunk)) {
+        fwrite(chunk.data, 1, chunk.length, writer->out);
+        free(chunk.data);
+    }
+    fflush(writer->out);
+    INSTRUMENT_MERGE_THREAD();
+    return NULL;
+}
+
+/**
+ * Starts a thread that writes to out whatever write_output_chunk is given
+ * returns 1, or 0 if the thread or its ring couldn't be made
+ */
+int start_output_writer(OutputWriter *writer, FILE *out) {
+    writer->out = out;
+    writer->finished = 0;
+    if (!init_spsc_ring(&writer->chunks, OUTPUT_WRITER_CHUNKS, sizeof(OutputChunk))) {
+        return 0;
+    }
+    if (pthread_create(&writer->thread, NULL, output_writer_thread, writer) != 0) {
+        free_spsc_ring(&writer->chunks);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Hands data, allocated with malloc, to the writer thread which frees it once
+ * written, waiting while OUTPUT_WRITER_CHUNKS chunks are still to be written
+ */
+void write_output_chunk(OutputWriter *writer, char *data, size_t length) {
+    OutputChunk chunk = {data, length};
+    spsc_push(&writer->chunks, &chunk);
+}
+
+// waits until everything handed to the writer is written out, out is left open, once finished it does nothing
+void finish_output_writer(OutputWriter *writer) {
+    if (writer->finished) {
+        return;
+    }
+    spsc_close(&writer->chunks);
+    pthread_join(writer->thread, NULL);
+    free_spsc_ring(&writer->chunks);
+    writer->finished = 1;
+}
@@ -0,0 +1,54 @@
+/**
+ * Pipeline Stages
+ */
+
+#ifndef SCHEDULERS_PIPELINE_H
+#define SCHEDULERS_PIPELINE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#define CACHE_LINE_SIZE 64
+
+/* A bounded queue between exactly one producer thread and one consumer
+ * thread. Each side only writes its own index, so neither takes a lock, and a
+ * full ring holds the producer back until the consumer catches up.
+ */
+typedef struct SpscRing {
+    char *slots;
+    size_t slot_size;
+    unsigned int mask; // capacity - 1, the capacity is a power of two
+    // written by the producer
+    unsigned int tail __attribute__((aligned(CACHE_LINE_SIZE)));
+    unsigned int cached_head; // the last head the producer saw
+    int closed; // nothing more will be pushed
+    // written by the consumer
+    unsigned int head __attribute__((aligned(CACHE_LINE_SIZE)));
+    unsigned int cached_tail;
+    int abandoned; // nothing more will be popped
+} SpscRing;
+
+int init_spsc_ring(SpscRing *ring, int capacity, size_t slot_size);
+void free_spsc_ring(SpscRing *ring);
+int spsc_push(SpscRing *ring, const void *item);
+int spsc_pop(SpscRing *ring, void *item);
+int spsc_try_pop(SpscRing *ring, void *item);
+void spsc_close(SpscRing *ring);
+void spsc_abandon(SpscRing *ring);
+
+// chunks of output in flight to the writer thread at most, each one a timeline buffer
+#define OUTPUT_WRITER_CHUNKS 8
+
+// a thread that writes the chunks handed to it to out, in order
+typedef struct OutputWriter {
+    FILE *out;
+    SpscRing chunks;
+    pthread_t thread;
+    int finished; // everything is written and the thread is gone, out can be written to directly
+} OutputWriter;
+
+int start_output_writer(OutputWriter *writer, FILE *out);
+void write_output_chunk(OutputWriter *writer, char *data, size_t length);
+void finish_output_writer(OutputWriter *writer);
+
+#endif //SCHEDULERS_PIPELINE_H
@@ -0,0 +1,399 @@
+/**
+ * Scheduling Policies
+ *
+ * The tick engine every algorithm but RR's historical one runs on, which
+ * leaves the choice of what runs next to a policy: where a ready process
+ * goes, which one is picked when the cpu is free, and whether the running
+ * one is sent back. FCFS and RR keep a fifo ring buffer, SJF, SRTF and
+ * priority a min-heap so insert and pick stay O(log n) however long the ready
+ * queue gets, and MLFQ a feedback queue whose levels it moves processes
+ * between as they use up their quanta.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "policy.h"
+
+// returns 1, or 0 if there is not enough memory
+int init_ready_queue(ReadyQueue *queue, int capacity, int quantum) {
+    int allocated;
+    if (capacity < 4) {
+        capacity = 4;
+    }
+    memset(queue, 0, sizeof(ReadyQueue));
+    allocated = init_process_queue(&queue->fifo, capacity);
+    queue->heap = malloc(sizeof(ReadyEntry) * capacity);
+    INSTRUMENT_COUNT(allocations);
+    queue->count = 0;
+    queue->capacity = queue->heap == NULL ? 0 : capacity;
+    queue->next_seq = 0;
+    queue->quantum = quantum;
+    return allocated && queue->heap != NULL;
+}
+
+void free_ready_queue(ReadyQueue *queue) {
+    free_process_queue(&queue->fifo);
+    free(queue->heap);
+    free_feedback_queue(&queue->feedback);
+    queue->heap = NULL;
+    queue->count = queue->capacity = 0;
+}
+
+int is_ready_queue_empty(ReadyQueue *queue) {
+    return queue->fifo.count == 0 && queue->count == 0 && queue->feedback.count == 0;
+}
+
+int ready_queue_length(ReadyQueue *queue) {
+    return queue->fifo.count + queue->count + queue->feedback.count;
+}
+
+static int ready_before(ReadyEntry *a, ReadyEntry *b) {
+    if (a->key != b->key) {
+        return a->key < b->key;
+    }
+    return a->seq < b->seq;
+}
+
+static void push_ready(ReadyQueue *queue, int key, Process *process) {
+    if (queue->count == queue->capacity) {
+        ReadyEntry *heap = realloc(queue->heap, sizeof(ReadyEntry) * queue->capacity * 2);
+        INSTRUMENT_COUNT(allocations);
+        if (heap == NULL) {
+            queue->no_memory = 1;
+            return;
+        }
+        queue->heap = heap;
+        queue->capacity *= 2;
+    }
+    INSTRUMENT_COUNT(queue_ops);
+
+    ReadyEntry entry;
+    entry.key = key;
+    entry.seq = queue->next_seq++;
+    entry.process = process;
+
+    // sift up
+    int i = queue->count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!ready_before(&entry, &queue->heap[parent])) {
+            break;
+        }
+        queue->heap[i] = queue->heap[parent];
+        i = parent;
+    }
+    queue->heap[i] = entry;
+}
+
+static Process* pop_ready(ReadyQueue *queue) {
+    if (queue->count == 0) {
+        return NULL;
+    }
+    Process *top = queue->heap[0].process;
+    INSTRUMENT_COUNT(queue_ops);
+
+    // move the last entry to the root and sift it down
+    ReadyEntry last = queue->heap[--queue->count];
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= queue->count) {
+            break;
+        }
+        if (child + 1 < queue->count && ready_before(&queue->heap[child + 1], &queue->heap[child])) {
+            child++;
+        }
+        if (!ready_before(&queue->heap[child], &last)) {
+            break;
+        }
+        queue->heap[i] = queue->heap[child];
+        i = child;
+    }
+    queue->heap[i] = last;
+    return top;
+}
+
+/**
+ * The cpu time left until the process blocks or terminates, a cpu, io, cpu
+ * process without io runs both of its cpu bursts back to back. Of a burst
+ * list only the burst the process is in counts
+ */
+static int remaining_burst(Process *process) {
+    int remaining = process->cpu_time - process->spent_cpu_time;
+    if (process->io_time == 0 && process->burst_offset < 0 && process->bursts_taken < process->burst_count) {
+        remaining += process->cpu_time;
+    }
+    return remaining;
+}
+
+static void fifo_insert(ReadyQueue *queue, Process *process) {
+    if (!enque(&queue->fifo, process)) {
+        queue->no_memory = 1;
+    }
+}
+
+static Process* fifo_pick_next(ReadyQueue *queue) {
+    return deque(&queue->fifo);
+}
+
+static int rr_should_preempt(ReadyQueue *queue, Process *running, int run_time) {
+    (void) running;
+    // nobody to hand the cpu to, the quantum just starts over
+    return run_time >= queue->quantum && queue->fifo.count > 0;
+}
+
+static void burst_insert(ReadyQueue *queue, Process *process) {
+    push_ready(queue, remaining_burst(process), process);
+}
+
+static int srtf_should_preempt(ReadyQueue *queue, Process *running, int run_time) {
+    (void) run_time;
+    return queue->count > 0 && queue->heap[0].key < remaining_burst(running);
+}
+
+static void priority_insert(ReadyQueue *queue, Process *process) {
+    push_ready(queue, process->priority, process);
+}
+
+static int priority_should_preempt(ReadyQueue *queue, Process *running, int run_time) {
+    (void) run_time;
+    return queue->count > 0 && queue->heap[0].key < running->priority;
+}
+
+/* Processes arrive at level 0, a process that runs its level's whole
+ * quantum, however many times it was preempted or blocked on the way, goes a
+ * level down and back behind the others of that level, and every
+ * boost_interval ticks all of them are back at level 0. A process at a higher
+ * level than the running one preempts it.
+ */
+static int mlfq_init(ReadyQueue *queue, SchedulerContext *context) {
+    int level;
+    if (!init_feedback_queue(&queue->feedback, context->processes, context->no_of_processes, context->levels)) {
+        return 0;
+    }
+    // each level's quantum, doubling from one level to the next unless given
+    for (level = 0; level < queue->feedback.level_count; level++) {
+        if (context->level_quanta != NULL) {
+            queue->quanta[level] = context->level_quanta[level];
+        } else if (level == 0) {
+            queue->quanta[level] = context->quantum;
+        } else {
+            queue->quanta[level] = queue->quanta[level - 1] > INT_MAX / 2 ? INT_MAX : queue->quanta[level - 1] * 2;
+        }
+        if (queue->quanta[level] < 1) {
+            queue->quanta[level] = 1;
+        }
+    }
+    queue->boost_interval = context->boost_interval;
+    return 1;
+}
+
+static void mlfq_insert(ReadyQueue *queue, Process *process) {
+    feedback_enque(&queue->feedback, process);
+}
+
+static Process* mlfq_pick_next(ReadyQueue *queue) {
+    return feedback_deque(&queue->feedback);
+}
+
+static int mlfq_should_preempt(ReadyQueue *queue, Process *running, int run_time) {
+    (void) run_time;
+    // a process that used up its quantum also gives way to the ones at its new level
+    int level = feedback_level(&queue->feedback, running);
+    unsigned int above = queue->expired ? (2u << level) - 1 : (1u << level) - 1;
+    return (queue->feedback.nonempty & above) != 0;
+}
+
+static void mlfq_tick(ReadyQueue *queue, Process *ran, int tick) {
+    queue->expired = 0;
+    if (ran != NULL) {
+        queue->expired = charge_feedback_tick(&queue->feedback, ran,
+                                              queue->quanta[feedback_level(&queue->feedback, ran)]);
+    }
+    if (queue->boost_interval > 0 && tick > 0 && tick % queue->boost_interval == 0) {
+        boost_feedback_queue(&queue->feedback);
+    }
+}
+
+const Policy fcfs_policy = {"fcfs", NULL, fifo_insert, fifo_pick_next, NULL, NULL};
+const Policy rr_policy = {"rr", NULL, fifo_insert, fifo_pick_next, rr_should_preempt, NULL};
+const Policy sjf_policy = {"sjf", NULL, burst_insert, pop_ready, NULL, NULL};
+const Policy srtf_policy = {"srtf", NULL, burst_insert, pop_ready, srtf_should_preempt, NULL};
+const Policy priority_policy = {"priority", NULL, priority_insert, pop_ready, priority_should_preempt, NULL};
+const Policy mlfq_policy = {"mlfq", mlfq_init, mlfq_insert, mlfq_pick_next, mlfq_should_preempt, mlfq_tick};
+
+const Policy* find_policy(int alg_type) {
+    switch (alg_type) {
+        case FCFS_ALGORITHM:
+            return &fcfs_policy;
+        case SJF_ALGORITHM:
+            return &sjf_policy;
+        case SRTF_ALGORITHM:
+            return &srtf_policy;
+        case PRIORITY_ALGORITHM:
+            return &priority_policy;
+        case MLFQ_ALGORITHM:
+            return &mlfq_policy;
+        default:
+            return &rr_policy;
+    }
+}
+
+/**
+ * Merges two lists of processes that are each ordered by process id
+ * returns the number of processes in merged
+ */
+int merge_processes_by_id(Process **merged, Process **first, int first_count, Process **second, int second_count) {
+    int i = 0, j = 0, k = 0;
+    while (i < first_count && j < second_count) {
+        if (second[j]->process_id < first[i]->process_id) {
+            merged[k++] = second[j++];
+        } else {
+            merged[k++] = first[i++];
+        }
+    }
+    while (i < first_count) {
+        merged[k++] = first[i++];
+    }
+    while (j < second_count) {
+        merged[k++] = second[j++];
+    }
+    return k;
+}
+
+/**
+ * One tick of the policy engine on one cpu once its arrivals are in: the
+ * io that completes, the running process's tick, the ready processes going
+ * in by process id, then the policy may send the running process back and a
+ * free cpu takes the next ready one
+ * returns the process that terminated at this tick, or NULL
+ */
+Process* policy_tick(SchedulerContext *context, const Policy *policy, ReadyQueue *queue, BlockedSet *blocked,
+                     PolicyCpu *cpu, Process **arrived, int arrived_count, Process **woken, Process **ready, int tick) {
+    Process *ran = cpu->running, *terminated = NULL;
+    int woken_count = wake_processes(context, blocked, woken, tick);
+    int ready_count, i;
+
+    if (ran != NULL) {
+        cpu->run_time++;
+        switch (advance_running(context, blocked, ran, tick)) {
+            case BURST_TERMINATES:
+                terminated = ran;
+                cpu->running = NULL;
+                break;
+            case BURST_BLOCKS:
+                cpu->running = NULL;
+                break;
+            default:
+                break;
+        }
+    }
+
+    ready_count = merge_processes_by_id(ready, arrived, arrived_count, woken, woken_count);
+    for (i = 0; i < ready_count; i++) {
+        policy->insert(queue, ready[i]);
+    }
+    if (policy->tick != NULL) {
+        policy->tick(queue, ran, tick);
+    }
+
+    INSTRUMENT_BEGIN(DISPATCH_TIMING);
+    if (cpu->running != NULL && policy->should_preempt != NULL &&
+        policy->should_preempt(queue, cpu->running, cpu->run_time)) {
+        set_status(context, cpu->running, READY);
+        policy->insert(queue, cpu->running);
+        cpu->running = NULL;
+        INSTRUMENT_COUNT(preemptions);
+    }
+
+    if (cpu->running == NULL) {
+        cpu->running = policy->pick_next(queue);
+        if (cpu->running != NULL) {
+            set_status(context, cpu->running, RUNNING);
+            cpu->run_time = 0;
+        } else {
+            cpu->not_utilized_count++;
+            report_idle(context);
+            INSTRUMENT_COUNT(idle_ticks);
+        }
+    }
+    INSTRUMENT_END(DISPATCH_TIMING);
+    return terminated;
+}
+
+/**
+ * Runs the context's processes under the policy, writing every tick of the
+ * timeline and the summary
+ * returns RUN_OK, or RUN_NO_MEMORY if there is not enough memory for the run
+ */
+int run_policy(SchedulerContext *context, const Policy *policy) {
+    Process **process_list = context->process_list;
+    int no_of_processes = context->no_of_processes;
+
+    // a preempted process goes back in before the next one leaves, hence the extra slot
+    ReadyQueue queue;
+    if (!init_ready_queue(&queue, no_of_processes + 1, context->quantum) ||
+        (policy->init != NULL && !policy->init(&queue, context))) {
+        free_ready_queue(&queue);
+        return RUN_NO_MEMORY;
+    }
+
+    Timeline timeline;
+    timeline_init(&timeline, context->out, FCFS_TIMELINE, context->timeline_mode, context->summary_format,
+                  process_list, context->status, no_of_processes);
+    timeline.writer = context->writer;
+    subscribe_timeline(context, &timeline);
+
+    ArrivalIndex arrivals;
+    int allocated = build_arrival_index(&arrivals, process_list, no_of_processes);
+
+    BlockedSet blocked;
+    allocated &= init_blocked_set(&blocked, no_of_processes);
+
+    Process **to_be_enqued = malloc(sizeof(Process*) * (no_of_processes + 1));
+    Process **woken = malloc(sizeof(Process*) * (no_of_processes + 1));
+    Process **ready = malloc(sizeof(Process*) * (no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 3);
+    int to_be_enqued_count;
+    int result = allocated && to_be_enqued != NULL && woken != NULL && ready != NULL ? RUN_OK : RUN_NO_MEMORY;
+
+    PolicyCpu cpu = {NULL, 0, 0};
+    int terminated_count = 0;
+    int tick = 0;
+
+    while (result == RUN_OK && terminated_count != no_of_processes) {
+        context->now = tick;
+        to_be_enqued_count = admit_arrivals(context, &arrivals, to_be_enqued, tick);
+        if (policy_tick(context, policy, &queue, &blocked, &cpu, to_be_enqued, to_be_enqued_count, woken, ready,
+                        tick) != NULL) {
+            terminated_count++;
+        }
+        if (queue.no_memory) {
+            result = RUN_NO_MEMORY;
+            break;
+        }
+
+        timeline_tick(&timeline, tick);
+        tick++;
+
+        if (cpu.running == NULL && is_ready_queue_empty(&queue) && blocked.count == 0 &&
+            next_arrival_time(&arrivals) == -1) {
+            // nothing left that could ever change the state
+            break;
+        }
+    }
+    if (result == RUN_OK) {
+        report_results(context, &timeline, tick, cpu.not_utilized_count);
+    } else {
+        timeline_finish(&timeline);
+    }
+
+    free_ready_queue(&queue);
+    free_blocked_set(&blocked);
+    free_arrival_index(&arrivals);
+    free(to_be_enqued);
+    free(woken);
+    free(ready);
+    return result;
+}
@@ -0,0 +1,70 @@
+/**
+ * Scheduling Policies
+ */
+
+#ifndef SCHEDULERS_POLICY_H
+#define SCHEDULERS_POLICY_H
+#include "fcfs.h"
+
+typedef struct ReadyEntry {
+    int key;
+    long seq; // processes with the same key leave in the order they were inserted
+    Process *process;
+} ReadyEntry;
+
+/* The ready queue of a run, a ring buffer for the fifo policies, a min-heap
+ * on key for SJF, SRTF and priority and the levels of a feedback queue for MLFQ
+ */
+typedef struct ReadyQueue {
+    ProcessQueue fifo;
+    ReadyEntry *heap;
+    int count;
+    int capacity;
+    long next_seq;
+    int quantum;
+    FeedbackQueue feedback;
+    int quanta[MLFQ_MAX_LEVELS]; // of each feedback level
+    int boost_interval;
+    int expired; // the process that ran the last tick used up its level's quantum with it
+    int no_memory; // an insert could not grow the queue, the process was left out and the run fails
+} ReadyQueue;
+
+typedef struct Policy {
+    const char *name;
+    // sets up what the policy keeps besides the fifo and the heap, NULL if nothing, returns 0 without the memory
+    int (*init)(ReadyQueue *queue, SchedulerContext *context);
+    void (*insert)(ReadyQueue *queue, Process *process);
+    Process* (*pick_next)(ReadyQueue *queue); // NULL when nothing is ready
+    // 1 if the running process, running for run_time ticks since it was picked, goes back to the queue now
+    int (*should_preempt)(ReadyQueue *queue, Process *running, int run_time);
+    // once a tick after the ready processes went in, with the process that ran the tick or NULL, may be NULL
+    void (*tick)(ReadyQueue *queue, Process *ran, int tick);
+} Policy;
+
+// the cpu a policy engine run on one cpu keeps, between ticks
+typedef struct PolicyCpu {
+    Process *running;
+    int run_time; // ticks since running was picked
+    int not_utilized_count;
+} PolicyCpu;
+
+int init_ready_queue(ReadyQueue *queue, int capacity, int quantum);
+void free_ready_queue(ReadyQueue *queue);
+int is_ready_queue_empty(ReadyQueue *queue);
+int ready_queue_length(ReadyQueue *queue);
+
+extern const Policy fcfs_policy;
+extern const Policy rr_policy;
+extern const Policy sjf_policy;
+extern const Policy srtf_policy;
+extern const Policy priority_policy;
+extern const Policy mlfq_policy;
+
+const Policy* find_policy(int alg_type);
+int merge_processes_by_id(Process **merged, Process **first, int first_count, Process **second, int second_count);
+
+Process* policy_tick(SchedulerContext *context, const Policy *policy, ReadyQueue *queue, BlockedSet *blocked,
+                     PolicyCpu *cpu, Process **arrived, int arrived_count, Process **woken, Process **ready, int tick);
+int run_policy(SchedulerContext *context, const Policy *policy);
+
+#endif //SCHEDULERS_POLICY_H
@@ -1,57 +1,213 @@
 #include "process.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "instrument.h"
 
-void sort_process_list(Process** process_list, int no_of_processes) {
-    int count = 0;
-    int swapped = 1;
+// lists shorter than this are insertion sorted, it beats setting up anything else
+#define SMALL_SORT_SIZE 32
+// counting sort is used when a key spans at most this many values per process
+#define DENSE_KEY_FACTOR 4
+
+static int compare_arrival_then_id(Process *a, Process *b) {
+    if (a->arrival_time != b->arrival_time) {
+        return a->arrival_time < b->arrival_time ? -1 : 1;
+    }
+    if (a->process_id != b->process_id) {
+        return a->process_id < b->process_id ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compare_id(Process *a, Process *b) {
+    if (a->process_id != b->process_id) {
+        return a->process_id < b->process_id ? -1 : 1;
+    }
+    return 0;
+}
+
+static int get_arrival_time(Process *p) {
+    return p->arrival_time;
+}
+
+static int get_process_id(Process *p) {
+    return p->process_id;
+}
+
+static void insertion_sort(Process** process_list, int no_of_processes, int (*compare)(Process*, Process*)) {
+    int i, j;
     Process* temp;
-    int sorted = 0;
-
-    while(swapped == 1)
-    {
-        swapped = 0;
-
-        for(count = sorted; count < no_of_processes - sorted - 1; count++) {
-            if (process_list[count]->arrival_time > process_list[count + 1]->arrival_time) {
-                //sorting by arrival time
-                temp = process_list[count];
-                process_list[count] = process_list[count + 1];
-                process_list[count + 1] = temp;
-                swapped = 1;
-            }
+    for (i = 1; i < no_of_processes; i++) {
+        temp = process_list[i];
+        j = i - 1;
+        // strictly greater keeps equal keys in their original order
+        while (j >= 0 && compare(process_list[j], temp) > 0) {
+            process_list[j + 1] = process_list[j];
+            j--;
+        }
+        process_list[j + 1] = temp;
+    }
+}
+
+/**
+ * Stable bottom up merge sort, runs of SMALL_SORT_SIZE are insertion sorted first,
+ * without the memory to merge into the whole list is insertion sorted
+ */
+static void merge_sort(Process** process_list, int no_of_processes, int (*compare)(Process*, Process*)) {
+    Process** temp = malloc(sizeof(Process*) * no_of_processes);
+    INSTRUMENT_COUNT(allocations);
+    if (temp == NULL) {
+        insertion_sort(process_list, no_of_processes, compare);
+        return;
+    }
+    Process** from = process_list;
+    Process** to = temp;
+    Process** swap;
+    int width, left, mid, right, i, j, k;
+
+    for (left = 0; left < no_of_processes; left += SMALL_SORT_SIZE) {
+        right = left + SMALL_SORT_SIZE < no_of_processes ? left + SMALL_SORT_SIZE : no_of_processes;
+        insertion_sort(process_list + left, right - left, compare);
+    }
 
-            if (process_list[count]->arrival_time == process_list[count + 1]->arrival_time &&
-                process_list[count]->process_id > process_list[count + 1]->process_id) {
-                //sorting process id
-                temp = process_list[count];
-                process_list[count] = process_list[count + 1];
-                process_list[count + 1] = temp;
-                swapped = 1;
+    for (width = SMALL_SORT_SIZE; width < no_of_processes; width *= 2) {
+        for (left = 0; left < no_of_processes; left += 2 * width) {
+            mid = left + width < no_of_processes ? left + width : no_of_processes;
+            right = left + 2 * width < no_of_processes ? left + 2 * width : no_of_processes;
+            i = left;
+            j = mid;
+            k = left;
+            while (i < mid && j < right) {
+                if (compare(from[j], from[i]) < 0) {
+                    to[k++] = from[j++];
+                } else {
+                    to[k++] = from[i++];
+                }
+            }
+            while (i < mid) {
+                to[k++] = from[i++];
+            }
+            while (j < right) {
+                to[k++] = from[j++];
             }
         }
-        sorted++;
+        swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != process_list) {
+        memcpy(process_list, from, sizeof(Process*) * no_of_processes);
     }
+    free(temp);
 }
 
+/**
+ * Finds the smallest and largest key in the list
+ * returns 1 if the keys are dense enough for a counting sort
+ */
+static int is_dense_key(Process** process_list, int no_of_processes, int (*key)(Process*), int *min, int *max) {
+    int i, value;
+    *min = *max = key(process_list[0]);
+    for (i = 1; i < no_of_processes; i++) {
+        value = key(process_list[i]);
+        if (value < *min) {
+            *min = value;
+        } else if (value > *max) {
+            *max = value;
+        }
+    }
+    return (long long) *max - *min < (long long) no_of_processes * DENSE_KEY_FACTOR;
+}
+
+/**
+ * Stable counting sort from process_list into sorted by a key spanning [min, max]
+ */
+static void counting_sort(Process** process_list, Process** sorted, int no_of_processes,
+                          int (*key)(Process*), int min, int max) {
+    int range = max - min + 1;
+    int *counts = calloc(range + 1, sizeof(int));
+    INSTRUMENT_COUNT(allocations);
+    int i;
+
+    for (i = 0; i < no_of_processes; i++) {
+        counts[key(process_list[i]) - min + 1]++;
+    }
+    for (i = 1; i <= range; i++) {
+        counts[i] += counts[i - 1];
+    }
+    for (i = 0; i < no_of_processes; i++) {
+        sorted[counts[key(process_list[i]) - min]++] = process_list[i];
+    }
+    free(counts);
+}
+
+static int is_sorted(Process** process_list, int no_of_processes, int (*compare)(Process*, Process*)) {
+    int i;
+    for (i = 1; i < no_of_processes; i++) {
+        if (compare(process_list[i - 1], process_list[i]) > 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Sorts the process list by arrival time then process id, processes with the
+ * same arrival time and id keep their order
+ * Dense integer keys take two counting sort passes, anything else a merge sort
+ */
+void sort_process_list(Process** process_list, int no_of_processes) {
+    int min_id, max_id, min_arrival, max_arrival;
+    Process** temp;
+
+    if (no_of_processes < SMALL_SORT_SIZE) {
+        insertion_sort(process_list, no_of_processes, compare_arrival_then_id);
+        return;
+    }
+    if (is_sorted(process_list, no_of_processes, compare_arrival_then_id)) {
+        return;
+    }
+
+    if (is_dense_key(process_list, no_of_processes, get_process_id, &min_id, &max_id) &&
+        is_dense_key(process_list, no_of_processes, get_arrival_time, &min_arrival, &max_arrival)) {
+        // least significant key first, the second pass is stable so ids stay in order
+        temp = malloc(sizeof(Process*) * no_of_processes);
+        INSTRUMENT_COUNT(allocations);
+        if (temp != NULL) {
+            counting_sort(process_list, temp, no_of_processes, get_process_id, min_id, max_id);
+            counting_sort(temp, process_list, no_of_processes, get_arrival_time, min_arrival, max_arrival);
+            free(temp);
+            return;
+        }
+    }
+    merge_sort(process_list, no_of_processes, compare_arrival_then_id);
+}
+
+/**
+ * Sorts the process list by process id, processes with the same id keep their order
+ */
 void sort_process_list_by_id(Process** process_list, int no_of_processes) {
-    int count = 0;
-    int swapped = 1;
-    Process* temp;
-    int sorted = 0;
-
-    while(swapped == 1)
-    {
-        swapped = 0;
-
-        for(count = sorted; count < no_of_processes - sorted - 1; count++) {
-            if (process_list[count+1] != NULL && process_list[count]->process_id > process_list[count + 1]->process_id) {
-                //sorting by arrival time
-                temp = process_list[count];
-                process_list[count] = process_list[count + 1];
-                process_list[count + 1] = temp;
-                swapped = 1;
-            }
+    int min_id, max_id;
+    Process** temp;
+
+    if (no_of_processes < SMALL_SORT_SIZE) {
+        insertion_sort(process_list, no_of_processes, compare_id);
+        return;
+    }
+    if (is_sorted(process_list, no_of_processes, compare_id)) {
+        return;
+    }
+
+    if (is_dense_key(process_list, no_of_processes, get_process_id, &min_id, &max_id)) {
+        temp = malloc(sizeof(Process*) * no_of_processes);
+        INSTRUMENT_COUNT(allocations);
+        if (temp != NULL) {
+            counting_sort(process_list, temp, no_of_processes, get_process_id, min_id, max_id);
+            memcpy(process_list, temp, sizeof(Process*) * no_of_processes);
+            free(temp);
+            return;
         }
-        sorted++;
     }
-}
\ No newline at end of file
+    merge_sort(process_list, no_of_processes, compare_id);
+}
@@ -5,22 +5,34 @@
 #ifndef SCHEDULERS_PROCESS_H
 #define SCHEDULERS_PROCESS_H
 
-#endif //SCHEDULERS_PROCESS_H
-
 enum Status {RUNNING, READY, BLOCKING, TERMINATED, NONE};
 
+// every field is an int so binary workloads can store processes in this exact layout
 typedef struct Process {
-    int status; // 0: Running, 1: Ready, 2: Blocking, 3: Terminated, None: 4
+    // from the processes info file, binary workloads rely on these coming first
     int process_id;
     int cpu_time;
     int io_time;
     int arrival_time;
+    int status; // 0: Running, 1: Ready, 2: Blocking, 3: Terminated, None: 4
     // for the scheduler program
     int spent_cpu_time;
     int spent_io_time;
     int turnaround;
-    int executionStatus; //0 in first burst, 1 in blocking, 2 in iO burst
+    int executionStatus; //0 in first burst, 1 in blocking, 2 in iO burst, with a burst list 0 until its last cpu burst
+    // for the event driven engine
+    int io_deadline; // tick at which the current io burst completes
+    // optional fifth column of the processes info file, lower runs first under the priority policy
+    int priority;
+    // the process's bursts, cpu, io, cpu unless it has a burst list, see bursts.h
+    int burst_offset; // where the rest of its burst list starts in the burst table, -1 without a list
+    int burst_count; // bursts after the first cpu and io burst, 1 without a list
+    int next_burst; // the byte of the burst table its next burst is decoded from
+    int bursts_taken; // how many of those it has reached
+    int work; // the cpu and io time of all its bursts
 } Process;
 
 void sort_process_list(Process** process_list, int no_of_processes);
 void sort_process_list_by_id(Process** process_list, int no_of_processes);
+
+#endif //SCHEDULERS_PROCESS_H
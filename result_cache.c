@@ -0,0 +1,547 @@
+/**
+ * Result Cache
+ *
+ * Keeps the output of runs on disk keyed by what it depends on: the workload
+ * file, with the blanks and blank lines the loader skips taken out of text
+ * ones, every argument of the run and the engine version. A run that finds
+ * its key writes the stored output without loading the workload at all.
+ * Results are found by name, a hit touches the file, and once the files add
+ * up to more than the cache's size the ones touched longest ago are removed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "result_cache.h"
+#include "scheduler.h"
+#include "loader.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+#define KEY_SEED 0x5c4ed7c3a1b2e9f1ULL
+// a temporary file this old belongs to a run that never finished writing it
+#define STALE_TEMPORARY_SECONDS 600
+
+// the key of a run as it is hashed, eight bytes at a time
+typedef struct KeyHash {
+    uint64_t hash;
+    uint64_t length;
+    unsigned char block[8];
+    int filled;
+} KeyHash;
+
+// a result file as it is on disk
+typedef struct CachedFile {
+    char *name;
+    long long size;
+    struct timespec used;
+} CachedFile;
+
+static uint64_t fnv1a(const unsigned char *bytes, size_t size, uint64_t hash) {
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static void put_u32(unsigned char *bytes, uint32_t value) {
+    bytes[0] = value & 0xff;
+    bytes[1] = (value >> 8) & 0xff;
+    bytes[2] = (value >> 16) & 0xff;
+    bytes[3] = (value >> 24) & 0xff;
+}
+
+static void put_u64(unsigned char *bytes, uint64_t value) {
+    put_u32(bytes, (uint32_t) value);
+    put_u32(bytes + 4, (uint32_t) (value >> 32));
+}
+
+static uint32_t get_u32(const unsigned char *bytes) {
+    return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+static uint64_t get_u64(const unsigned char *bytes) {
+    return (uint64_t) get_u32(bytes) | (uint64_t) get_u32(bytes + 4) << 32;
+}
+
+static uint64_t rotate_left(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// one multiply per eight bytes rather than per byte, workloads can be large
+static void hash_block(KeyHash *h) {
+    uint64_t word = get_u64(h->block);
+    word *= 0x87c37b91114253d5ULL;
+    word = rotate_left(word, 31);
+    word *= 0x4cf5ad432745937fULL;
+    h->hash ^= word;
+    h->hash = rotate_left(h->hash, 27) * 5 + 0x52dce729;
+    h->length += 8;
+    h->filled = 0;
+}
+
+static void hash_byte(KeyHash *h, unsigned char byte) {
+    h->block[h->filled++] = byte;
+    if (h->filled == 8) {
+        hash_block(h);
+    }
+}
+
+static void hash_int(KeyHash *h, int value) {
+    unsigned char bytes[4];
+    int i;
+    put_u32(bytes, (uint32_t) value);
+    for (i = 0; i < 4; i++) {
+        hash_byte(h, bytes[i]);
+    }
+}
+
+static uint64_t finish_hash(KeyHash *h) {
+    uint64_t length = h->length + h->filled;
+    // pad the last block, the length tells it apart from the same bytes followed by zeros
+    while (h->filled != 0) {
+        hash_byte(h, 0);
+    }
+    uint64_t hash = h->hash ^ length;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * Hashes a text workload the way the loader reads it: blanks only separate
+ * the numbers of a line and blank lines don't count
+ */
+static void hash_text_workload(KeyHash *h, const unsigned char *data, size_t size) {
+    int separated = 0, in_line = 0;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        unsigned char c = data[i];
+        if (c == '\n') {
+            if (in_line) {
+                hash_byte(h, '\n');
+            }
+            separated = in_line = 0;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            separated = in_line;
+        } else {
+            if (separated) {
+                hash_byte(h, ' ');
+                separated = 0;
+            }
+            hash_byte(h, c);
+            in_line = 1;
+        }
+    }
+    if (in_line) {
+        hash_byte(h, '\n');
+    }
+}
+
+/**
+ * Works out the key of a run of the workload in file_name with parameters,
+ * every argument its output depends on
+ * returns 1, or 0 if the file can't be read
+ */
+int result_cache_key(const char *file_name, const int *parameters, int parameter_count, uint64_t *key) {
+    struct stat file_stat;
+    unsigned char *data = NULL;
+    KeyHash h;
+    size_t offset;
+    int fd, i, binary;
+
+    fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return 0;
+    }
+    if (file_stat.st_size > 0) {
+        data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    memset(&h, 0, sizeof(KeyHash));
+    h.hash = KEY_SEED;
+    hash_int(&h, ENGINE_VERSION);
+    hash_int(&h, parameter_count);
+    for (i = 0; i < parameter_count; i++) {
+        hash_int(&h, parameters[i]);
+    }
+    // binary workloads are read as they are, see loader.h
+    binary = data != NULL && file_stat.st_size >= 8 && memcmp(data, WORKLOAD_MAGIC, 8) == 0;
+    hash_int(&h, binary);
+    if (binary) {
+        for (offset = 0; offset < (size_t) file_stat.st_size; offset++) {
+            hash_byte(&h, data[offset]);
+        }
+    } else if (data != NULL) {
+        hash_text_workload(&h, data, file_stat.st_size);
+    }
+    *key = finish_hash(&h);
+
+    if (data != NULL) {
+        munmap(data, file_stat.st_size);
+    }
+    return 1;
+}
+
+// the path of a file in the cache, the caller frees it
+static char* cache_path(ResultCache *cache, const char *name) {
+    char *path = malloc(strlen(cache->directory) + strlen(name) + 2);
+    INSTRUMENT_COUNT(allocations);
+    if (path != NULL) {
+        sprintf(path, "%s/%s", cache->directory, name);
+    }
+    return path;
+}
+
+static void result_name(char *name, uint64_t key) {
+    sprintf(name, "%016llx.result", (unsigned long long) key);
+}
+
+static int is_result_name(const char *name) {
+    size_t length = strlen(name);
+    return length == 23 && strcmp(name + 16, ".result") == 0 && strspn(name, "0123456789abcdef") == 16;
+}
+
+static int is_temporary_name(const char *name) {
+    size_t length = strlen(name);
+    return length > 4 && strcmp(name + length - 4, ".tmp") == 0;
+}
+
+/**
+ * Reads the result file at path, which has to be the one of key
+ * returns CACHE_OK with the file in *bytes, which the caller frees,
+ * CACHE_NOT_FOUND if there is no such file, CACHE_MALFORMED or CACHE_NO_MEMORY
+ */
+static int read_result(const char *path, uint64_t key, unsigned char **bytes, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    struct stat file_stat;
+    uint64_t length;
+    int ok;
+
+    *bytes = NULL;
+    if (f == NULL) {
+        return CACHE_NOT_FOUND;
+    }
+    if (fstat(fileno(f), &file_stat) != 0 || file_stat.st_size < RESULT_CACHE_HEADER_SIZE + 8) {
+        fclose(f);
+        return CACHE_MALFORMED;
+    }
+    *size = file_stat.st_size;
+    *bytes = malloc(*size);
+    INSTRUMENT_COUNT(allocations);
+    if (*bytes == NULL) {
+        fclose(f);
+        return CACHE_NO_MEMORY;
+    }
+    ok = fread(*bytes, 1, *size, f) == *size;
+    fclose(f);
+
+    length = ok ? get_u64(*bytes + 48) : 0;
+    if (!ok || memcmp(*bytes, RESULT_CACHE_MAGIC, 8) != 0 || get_u32(*bytes + 8) != RESULT_CACHE_VERSION ||
+        get_u64(*bytes + 16) != key || length != *size - RESULT_CACHE_HEADER_SIZE - 8 ||
+        fnv1a(*bytes, *size - 8, FNV_OFFSET_BASIS) != get_u64(*bytes + *size - 8)) {
+        free(*bytes);
+        *bytes = NULL;
+        return CACHE_MALFORMED;
+    }
+    return CACHE_OK;
+}
+
+/**
+ * Writes the output of a run the way it would have written it itself
+ */
+void write_cached_output(const CachedResult *result, const char *output, size_t length, FILE *out) {
+    if (length == 0) {
+        return;
+    }
+    if (result->flags & CACHED_RUN_LENGTH) {
+        FILE *in = fmemopen((void*) output, length, "r");
+        if (in != NULL) {
+            timeline_decode(in, out);
+            fclose(in);
+        }
+    } else {
+        fwrite(output, 1, length, out);
+    }
+}
+
+/**
+ * Looks the run with key up and, if it is there, writes the output it stored
+ * to out and its summary to result
+ * returns 1 if it is there, 0 if not, or CACHE_NO_MEMORY
+ */
+int find_cached_result(ResultCache *cache, uint64_t key, CachedResult *result, FILE *out) {
+    char name[24];
+    unsigned char *bytes;
+    size_t size;
+    uint64_t bits;
+    int found;
+
+    result_name(name, key);
+    char *path = cache_path(cache, name);
+    if (path == NULL) {
+        return CACHE_NO_MEMORY;
+    }
+    found = read_result(path, key, &bytes, &size);
+    if (found == CACHE_MALFORMED) {
+        // the run that finds it missing stores it again
+        unlink(path);
+    }
+    if (found != CACHE_OK) {
+        free(path);
+        return found == CACHE_NO_MEMORY ? CACHE_NO_MEMORY : 0;
+    }
+    // the time it was last used is what eviction goes by
+    utimensat(AT_FDCWD, path, NULL, 0);
+    free(path);
+
+    result->flags = get_u32(bytes + 12);
+    result->finishing_time = (int) get_u32(bytes + 24);
+    result->max_turnaround = (int) get_u32(bytes + 28);
+    bits = get_u64(bytes + 32);
+    memcpy(&result->cpu_utilization, &bits, sizeof(double));
+    bits = get_u64(bytes + 40);
+    memcpy(&result->average_turnaround, &bits, sizeof(double));
+
+    if (out != NULL) {
+        write_cached_output(result, (const char*) bytes + RESULT_CACHE_HEADER_SIZE,
+                            size - RESULT_CACHE_HEADER_SIZE - 8, out);
+    }
+    free(bytes);
+    return 1;
+}
+
+static int by_last_use(const void *a, const void *b) {
+    const CachedFile *x = a, *y = b;
+    if (x->used.tv_sec != y->used.tv_sec) {
+        return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+    }
+    if (x->used.tv_nsec != y->used.tv_nsec) {
+        return x->used.tv_nsec < y->used.tv_nsec ? -1 : 1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+/**
+ * Removes the results used longest ago until the rest fit in the cache's
+ * size. Runs that finish together take turns through a lock file, so each
+ * one sees the results the others left
+ */
+static void evict_results(ResultCache *cache) {
+    CachedFile *files = NULL;
+    int count = 0, capacity = 0, i;
+    long long total = 0;
+    struct dirent *entry;
+    struct stat file_stat;
+    DIR *dir;
+
+    char *lock_path = cache_path(cache, "lock");
+    int lock = lock_path == NULL ? -1 : open(lock_path, O_RDWR | O_CREAT, 0666);
+    free(lock_path);
+    if (lock < 0) {
+        return;
+    }
+    if (flock(lock, LOCK_EX) != 0 || (dir = opendir(cache->directory)) == NULL) {
+        close(lock);
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (!is_result_name(entry->d_name) ||
+            fstatat(dirfd(dir), entry->d_name, &file_stat, 0) != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            CachedFile *grown = realloc(files, sizeof(CachedFile) * capacity);
+            INSTRUMENT_COUNT(allocations);
+            if (grown == NULL) {
+                break;
+            }
+            files = grown;
+        }
+        files[count].name = strdup(entry->d_name);
+        files[count].size = file_stat.st_size;
+        files[count].used = file_stat.st_mtim;
+        total += file_stat.st_size;
+        count++;
+    }
+
+    if (total > cache->max_size) {
+        qsort(files, count, sizeof(CachedFile), by_last_use);
+        for (i = 0; i < count && total > cache->max_size; i++) {
+            // one already gone was evicted or purged by another run
+            if (files[i].name != NULL && unlinkat(dirfd(dir), files[i].name, 0) == 0) {
+                total -= files[i].size;
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        free(files[i].name);
+    }
+    free(files);
+    closedir(dir);
+    flock(lock, LOCK_UN);
+    close(lock);
+}
+
+/**
+ * Stores the output of the run with key and its summary in result, then
+ * evicts what no longer fits. A result larger than the whole cache isn't
+ * stored, it would only push every other one out
+ * returns CACHE_OK, CACHE_NO_MEMORY, or CACHE_NOT_FOUND if the cache can't be written
+ */
+int save_cached_result(ResultCache *cache, uint64_t key, const CachedResult *result,
+                       const char *output, size_t length) {
+    unsigned char header[RESULT_CACHE_HEADER_SIZE], trailer[8];
+    char name[24], temporary_name[64];
+    uint64_t bits, checksum;
+    int ok;
+
+    if ((long long) length > cache->max_size - RESULT_CACHE_HEADER_SIZE - 8) {
+        return CACHE_OK;
+    }
+    if (mkdir(cache->directory, 0777) != 0 && errno != EEXIST) {
+        return CACHE_NOT_FOUND;
+    }
+    result_name(name, key);
+    sprintf(temporary_name, "%016llx.%ld.tmp", (unsigned long long) key, (long) getpid());
+    char *path = cache_path(cache, name);
+    char *temporary = cache_path(cache, temporary_name);
+    if (path == NULL || temporary == NULL) {
+        free(path);
+        free(temporary);
+        return CACHE_NO_MEMORY;
+    }
+
+    memcpy(header, RESULT_CACHE_MAGIC, 8);
+    put_u32(header + 8, RESULT_CACHE_VERSION);
+    put_u32(header + 12, result->flags);
+    put_u64(header + 16, key);
+    put_u32(header + 24, (uint32_t) result->finishing_time);
+    put_u32(header + 28, (uint32_t) result->max_turnaround);
+    memcpy(&bits, &result->cpu_utilization, sizeof(double));
+    put_u64(header + 32, bits);
+    memcpy(&bits, &result->average_turnaround, sizeof(double));
+    put_u64(header + 40, bits);
+    put_u64(header + 48, (uint64_t) length);
+    checksum = fnv1a(header, sizeof(header), FNV_OFFSET_BASIS);
+    checksum = fnv1a((const unsigned char*) output, length, checksum);
+    put_u64(trailer, checksum);
+
+    FILE *f = fopen(temporary, "wb");
+    ok = f != NULL;
+    ok = ok && fwrite(header, sizeof(header), 1, f) == 1;
+    ok = ok && (length == 0 || fwrite(output, length, 1, f) == 1);
+    ok = ok && fwrite(trailer, sizeof(trailer), 1, f) == 1;
+    if (f != NULL && fclose(f) != 0) {
+        ok = 0;
+    }
+    // readers see the whole result or none of it
+    ok = ok && rename(temporary, path) == 0;
+    if (!ok) {
+        unlink(temporary);
+    }
+    free(path);
+    free(temporary);
+    if (!ok) {
+        return CACHE_NOT_FOUND;
+    }
+    evict_results(cache);
+    return CACHE_OK;
+}
+
+/**
+ * Reads every result in the cache back and removes the ones that are damaged
+ * and temporary files left behind by runs that stopped writing them, writing
+ * a line to report for each and a total at the end
+ * returns the number of results kept, or CACHE_NOT_FOUND if there is no cache
+ */
+int verify_result_cache(ResultCache *cache, FILE *report) {
+    DIR *dir = opendir(cache->directory);
+    struct dirent *entry;
+    struct stat file_stat;
+    unsigned char *bytes;
+    size_t size;
+    long long total = 0;
+    int kept = 0, removed = 0, found;
+
+    if (dir == NULL) {
+        return CACHE_NOT_FOUND;
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        char *path;
+        if (is_temporary_name(entry->d_name)) {
+            if (fstatat(dirfd(dir), entry->d_name, &file_stat, 0) == 0 &&
+                time(NULL) - file_stat.st_mtime > STALE_TEMPORARY_SECONDS &&
+                unlinkat(dirfd(dir), entry->d_name, 0) == 0) {
+                fprintf(report, "removed %s: unfinished\n", entry->d_name);
+                removed++;
+            }
+            continue;
+        }
+        if (!is_result_name(entry->d_name) || (path = cache_path(cache, entry->d_name)) == NULL) {
+            continue;
+        }
+        found = read_result(path, strtoull(entry->d_name, NULL, 16), &bytes, &size);
+        if (found == CACHE_OK) {
+            kept++;
+            total += size;
+        } else if (found == CACHE_MALFORMED && unlink(path) == 0) {
+            fprintf(report, "removed %s: damaged\n", entry->d_name);
+            removed++;
+        }
+        free(bytes);
+        free(path);
+    }
+    closedir(dir);
+    fprintf(report, "%d results, %lld bytes, %d removed\n", kept, total, removed);
+    return kept;
+}
+
+/**
+ * Removes every result and temporary file from the cache
+ * returns the number of files removed, or CACHE_NOT_FOUND if there is no cache
+ */
+int purge_result_cache(ResultCache *cache) {
+    DIR *dir = opendir(cache->directory);
+    struct dirent *entry;
+    int removed = 0;
+
+    if (dir == NULL) {
+        return CACHE_NOT_FOUND;
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        if ((is_result_name(entry->d_name) || is_temporary_name(entry->d_name)) &&
+            unlinkat(dirfd(dir), entry->d_name, 0) == 0) {
+            removed++;
+        }
+    }
+    closedir(dir);
+    return removed;
+}
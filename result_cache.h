@@ -0,0 +1,59 @@
+/**
+ * Result Cache
+ */
+
+#ifndef SCHEDULERS_RESULT_CACHE_H
+#define SCHEDULERS_RESULT_CACHE_H
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum CacheResult {CACHE_OK = 0, CACHE_NOT_FOUND = -1, CACHE_MALFORMED = -2, CACHE_NO_MEMORY = -3};
+
+/* A cache is a directory with a file per result named after its key, 16 hex
+ * digits and ".result", every field little endian:
+ *   0  magic "SCHEDRC\0"
+ *   8  u32 version
+ *  12  u32 flags
+ *  16  u64 key
+ *  24  u32 finishing time
+ *  28  u32 max turnaround
+ *  32  f64 cpu utilization
+ *  40  f64 average turnaround
+ *  48  u64 output length
+ * followed by the output the run wrote and a u64 FNV-1a checksum of
+ * everything before it. Results are written to a temporary file renamed into
+ * place, so any number of runs can share a cache without locking to read or
+ * add to it, and a result being read stays readable if it is evicted.
+ */
+#define RESULT_CACHE_MAGIC "SCHEDRC"
+#define RESULT_CACHE_VERSION 1
+#define RESULT_CACHE_HEADER_SIZE 56
+// the output is a run length encoded timeline, expanded to the full one when written
+#define CACHED_RUN_LENGTH 1
+// bytes a cache holds before the results least recently used are evicted
+#define DEFAULT_CACHE_SIZE (256LL << 20)
+
+typedef struct ResultCache {
+    const char *directory;
+    long long max_size;
+} ResultCache;
+
+// the summary of a run, as the context it ran in has it
+typedef struct CachedResult {
+    uint32_t flags;
+    int finishing_time;
+    int max_turnaround;
+    double cpu_utilization;
+    double average_turnaround;
+} CachedResult;
+
+int result_cache_key(const char *file_name, const int *parameters, int parameter_count, uint64_t *key);
+void write_cached_output(const CachedResult *result, const char *output, size_t length, FILE *out);
+int find_cached_result(ResultCache *cache, uint64_t key, CachedResult *result, FILE *out);
+int save_cached_result(ResultCache *cache, uint64_t key, const CachedResult *result,
+                       const char *output, size_t length);
+int verify_result_cache(ResultCache *cache, FILE *report);
+int purge_result_cache(ResultCache *cache);
+
+#endif //SCHEDULERS_RESULT_CACHE_H
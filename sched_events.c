@@ -0,0 +1,45 @@
+/**
+ * Scheduling Events
+ *
+ * The engines report a process's events through set_status, which sees every
+ * status change, and the few that aren't status changes (a preemption in rrr,
+ * the cpu going idle) themselves. None of it costs more than a NULL check
+ * unless the context has a sink, which it has whenever a timeline is written.
+ */
+
+#include <string.h>
+#include "sched_events.h"
+
+static const char *event_names[] = {"arrive", "dispatch", "preempt", "block", "unblock", "terminate", "idle"};
+
+void init_event_sink(EventSink *sink, SchedEventCallback callback, void *data, SpscRing *ring) {
+    memset(sink, 0, sizeof(EventSink));
+    sink->callback = callback;
+    sink->data = data;
+    sink->ring = ring;
+}
+
+void emit_event(EventSink *sink, int tick, int type, int process_id, int slot) {
+    SchedEvent event = {tick, type, process_id, slot};
+    for (; sink != NULL; sink = sink->next) {
+        // the tick engines look at an idle cpu every tick, only the first of them is an event
+        if (type == SCHED_IDLE) {
+            if (sink->idle) {
+                continue;
+            }
+            sink->idle = 1;
+        } else if (type == SCHED_DISPATCH) {
+            sink->idle = 0;
+        }
+        if (sink->callback != NULL) {
+            sink->callback(&event, sink->data);
+        }
+        if (sink->ring != NULL) {
+            spsc_push(sink->ring, &event);
+        }
+    }
+}
+
+const char* sched_event_name(int type) {
+    return type >= SCHED_ARRIVE && type <= SCHED_IDLE ? event_names[type] : "unknown";
+}
@@ -0,0 +1,50 @@
+/**
+ * Scheduling Events
+ */
+
+#ifndef SCHEDULERS_SCHED_EVENTS_H
+#define SCHEDULERS_SCHED_EVENTS_H
+#include "pipeline.h"
+
+/* What a run reports as it goes, each at the tick it happens:
+ *   ARRIVE     the process entered the ready queue for the first time
+ *   DISPATCH   it got the cpu
+ *   PREEMPT    it was sent back to the ready queue for another process
+ *   BLOCK      it started an io burst
+ *   UNBLOCK    its io burst completed, it is ready again
+ *   TERMINATE  it finished its last burst
+ *   IDLE       the cpu went idle, until the next DISPATCH, one cpu runs only
+ * Batch runs report none. A timeline being written is one more sink the
+ * run's events go to, see timeline.h.
+ */
+enum SchedEventType {SCHED_ARRIVE, SCHED_DISPATCH, SCHED_PREEMPT, SCHED_BLOCK, SCHED_UNBLOCK, SCHED_TERMINATE,
+                     SCHED_IDLE};
+
+// fixed size, so a ring of them can be handed between threads and stored as is
+typedef struct SchedEvent {
+    int tick;
+    int type;
+    int process_id; // -1 for SCHED_IDLE
+    int slot; // the process's index in the context's processes, -1 for SCHED_IDLE
+} SchedEvent;
+
+typedef void (*SchedEventCallback)(const SchedEvent *event, void *data);
+
+/* Where a run's events go: to a callback, called on the engine's thread with
+ * the event in place, and to a ring another thread pops them from, either or
+ * both. The ring holds the engine back while it is full. Every event goes on
+ * to the sinks chained behind through next as well.
+ */
+typedef struct EventSink {
+    SchedEventCallback callback; // NULL for none
+    void *data; // handed to the callback
+    SpscRing *ring; // of SchedEvent, NULL for none
+    int idle; // the cpu is idle, so another SCHED_IDLE is left out
+    struct EventSink *next; // NULL for none
+} EventSink;
+
+void init_event_sink(EventSink *sink, SchedEventCallback callback, void *data, SpscRing *ring);
+void emit_event(EventSink *sink, int tick, int type, int process_id, int slot);
+const char* sched_event_name(int type);
+
+#endif //SCHEDULERS_SCHED_EVENTS_H
@@ -0,0 +1,272 @@
+/**
+ * Scheduler Context
+ *
+ * The engines only ever write to the processes of the context they are given
+ * and to its output, so any number of contexts made from the same read only
+ * process list can be run at once, one per thread.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler.h"
+#include "fcfs.h"
+#include "event.h"
+#include "policy.h"
+#include "multicpu.h"
+
+/**
+ * Copies the processes in process_list, in their initial state, into a new
+ * context that runs FCFS on the event engine without any output
+ * returns 1, or 0 if there is not enough memory
+ */
+int init_scheduler_context(SchedulerContext *context, Process **process_list, int no_of_processes) {
+    int i;
+    memset(context, 0, sizeof(SchedulerContext));
+    context->processes = malloc(sizeof(Process) * ((size_t) no_of_processes + 1));
+    context->process_list = malloc(sizeof(Process*) * ((size_t) no_of_processes + 1));
+    context->status = malloc(sizeof(int) * ((size_t) no_of_processes + 1));
+    context->first_run = malloc(sizeof(int) * ((size_t) no_of_processes + 1));
+    INSTRUMENT_ADD(allocations, 4);
+    if (context->processes == NULL || context->process_list == NULL || context->status == NULL ||
+        context->first_run == NULL) {
+        free_scheduler_context(context);
+        return 0;
+    }
+
+    for (i = 0; i < no_of_processes; i++) {
+        Process *process = &context->processes[i];
+        memset(process, 0, sizeof(Process));
+        process->process_id = process_list[i]->process_id;
+        process->cpu_time = process_list[i]->cpu_time;
+        process->io_time = process_list[i]->io_time;
+        process->arrival_time = process_list[i]->arrival_time;
+        process->priority = process_list[i]->priority;
+        process->burst_offset = process_list[i]->burst_offset;
+        process->burst_count = process_list[i]->burst_count;
+        process->next_burst = process_list[i]->burst_offset;
+        process->work = process_list[i]->work;
+        process->status = NONE;
+        context->status[i] = NONE;
+        context->first_run[i] = -1;
+        context->process_list[i] = process;
+    }
+    context->process_list[no_of_processes] = NULL;
+    context->no_of_processes = no_of_processes;
+
+    context->alg_type = FCFS_ALGORITHM;
+    context->quantum = 1;
+    context->levels = DEFAULT_MLFQ_LEVELS;
+    context->engine = EVENT_ENGINE;
+    context->no_of_cpus = 1;
+    context->host_threads = 1;
+    context->timeline_mode = TIMELINE_NONE;
+    context->summary_format = SUMMARY_TEXT;
+    return 1;
+}
+
+/**
+ * Sets up a context without a process list but with room for capacity
+ * processes at once, run_stream fills the slots in as processes arrive
+ * returns 1, or 0 if there is not enough memory
+ */
+int init_stream_context(SchedulerContext *context, int capacity) {
+    int i;
+    memset(context, 0, sizeof(SchedulerContext));
+    context->processes = malloc(sizeof(Process) * ((size_t) capacity + 1));
+    context->status = malloc(sizeof(int) * ((size_t) capacity + 1));
+    context->first_run = malloc(sizeof(int) * ((size_t) capacity + 1));
+    INSTRUMENT_ADD(allocations, 3);
+    if (context->processes == NULL || context->status == NULL || context->first_run == NULL) {
+        free_scheduler_context(context);
+        return 0;
+    }
+    for (i = 0; i < capacity; i++) {
+        context->status[i] = NONE;
+        context->first_run[i] = -1;
+    }
+    context->no_of_processes = capacity;
+
+    context->alg_type = FCFS_ALGORITHM;
+    context->quantum = 1;
+    context->levels = DEFAULT_MLFQ_LEVELS;
+    context->engine = POLICY_ENGINE;
+    context->no_of_cpus = 1;
+    context->host_threads = 1;
+    context->timeline_mode = TIMELINE_NONE;
+    context->summary_format = SUMMARY_TEXT;
+    return 1;
+}
+
+void free_scheduler_context(SchedulerContext *context) {
+    free(context->first_run);
+    free(context->status);
+    free(context->process_list);
+    free(context->processes);
+    memset(context, 0, sizeof(SchedulerContext));
+}
+
+/**
+ * Runs the context's algorithm on the engine it asks for. Everything runs on
+ * the policy engine but FCFS and RR on the event engine, which have event
+ * engines of their own, and RR on the tick engine, which keeps rrr's
+ * historical state machine. Only rrr takes checkpoints, so RR with
+ * checkpoints runs on it, and MLFQ only runs on one cpu
+ * returns RUN_OK, RUN_NO_MEMORY if there is not enough memory for the run or
+ * the CheckpointResult of a checkpoint that could not be restored
+ */
+static int run_engine(SchedulerContext *context) {
+    if (context->no_of_cpus > 1 && context->alg_type != MLFQ_ALGORITHM) {
+        return run_multi_cpu(context, find_policy(context->alg_type));
+    }
+    if (context->alg_type == RR_ALGORITHM && (context->checkpoint_file != NULL || context->restore_file != NULL)) {
+        return rrr(context);
+    }
+    if (context->alg_type == FCFS_ALGORITHM && context->engine == EVENT_ENGINE) {
+        return run_fcfs_events(context);
+    }
+    if (context->alg_type == RR_ALGORITHM && context->engine != POLICY_ENGINE) {
+        return context->engine == EVENT_ENGINE ? rrr_events(context) : rrr(context);
+    }
+    return run_policy(context, find_policy(context->alg_type));
+}
+
+int run_scheduler(SchedulerContext *context) {
+    EventSink *events = context->events, *sink;
+    int i, result;
+    for (i = 0; i < context->no_of_processes; i++) {
+        context->first_run[i] = -1;
+    }
+    context->max_turnaround = 0;
+    context->average_turnaround = 0;
+    histogram_init(&context->waiting_times);
+    histogram_init(&context->response_times);
+    histogram_init(&context->turnaround_times);
+    for (sink = events; sink != NULL; sink = sink->next) {
+        sink->idle = 0;
+    }
+    result = run_engine(context);
+    // the engine's timeline was subscribed in front of the caller's sinks
+    context->events = events;
+    return result;
+}
+
+/**
+ * The event a status change of process stands for, looked at before the change
+ * returns the SchedEventType or -1 if the change is no event
+ */
+int status_event_type(const Process *process, int status) {
+    switch (status) {
+        case RUNNING:
+            return SCHED_DISPATCH;
+        case READY:
+            // preempted on the policy engines, rrr's preempted processes never leave RUNNING
+            return process->status == BLOCKING ? SCHED_UNBLOCK :
+                   process->status == RUNNING ? SCHED_PREEMPT : SCHED_ARRIVE;
+        case BLOCKING:
+            return SCHED_BLOCK;
+        case TERMINATED:
+            return SCHED_TERMINATE;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Reports the event a status change of process stands for, called by
+ * set_status before the change
+ */
+void report_status_event(SchedulerContext *context, Process *process, int status) {
+    int type = status_event_type(process, status);
+    if (type != -1) {
+        emit_event(context->events, context->now, type, process->process_id, (int) (process - context->processes));
+    }
+}
+
+const char* algorithm_name(int alg_type) {
+    if (alg_type == MLFQ_ALGORITHM) {
+        return "mlfq";
+    }
+    return find_policy(alg_type)->name;
+}
+
+void report_summary(SchedulerContext *context, Timeline *timeline, int finishing_time, double utilization) {
+    context->finishing_time = finishing_time;
+    context->cpu_utilization = utilization;
+    timeline_summary(timeline, finishing_time, utilization);
+}
+
+/**
+ * Writes the turnaround of a process and, if it terminated, adds it to the
+ * latency histograms. The turnaround is the engine's own, its waiting time is
+ * the turnaround less process->work, the ticks of cpu and io the process's
+ * bursts add up to
+ */
+void report_turnaround(SchedulerContext *context, Timeline *timeline, Process *process, int turnaround) {
+    // the average is kept as a running mean, summing could overflow an int
+    context->average_turnaround += (turnaround - context->average_turnaround) / (timeline->turnaround_count + 1);
+    if (timeline->turnaround_count == 0 || turnaround > context->max_turnaround) {
+        context->max_turnaround = turnaround;
+    }
+    if (process->status == TERMINATED) {
+        histogram_record(&context->turnaround_times, turnaround);
+        histogram_record(&context->waiting_times, turnaround - process->work);
+        histogram_record(&context->response_times,
+                         context->first_run[process - context->processes] - process->arrival_time);
+    }
+    timeline_turnaround(timeline, process->process_id, turnaround);
+}
+
+// writes the latency summaries if the context asks for them, after the last turnaround
+void report_latency(SchedulerContext *context, Timeline *timeline) {
+    LatencySummary latency;
+    if (!context->latency_report) {
+        return;
+    }
+    summarize_histogram(&context->waiting_times, &latency);
+    timeline_latency(timeline, "waiting", "Waiting Time", &latency);
+    summarize_histogram(&context->response_times, &latency);
+    timeline_latency(timeline, "response", "Response Time", &latency);
+    summarize_histogram(&context->turnaround_times, &latency);
+    timeline_latency(timeline, "turnaround", "Turnaround Time", &latency);
+}
+
+/**
+ * Writes the turnaround of every process of the context's list and the
+ * latency summaries, and finishes the timeline
+ */
+void report_turnarounds(SchedulerContext *context, Timeline *timeline) {
+    Process **process_list = context->process_list;
+    int count = 0;
+    Process *current_process = *process_list;
+    while (current_process != NULL) {
+        report_turnaround(context, timeline, current_process, current_process->turnaround);
+        current_process = process_list[++count];
+    }
+    report_latency(context, timeline);
+    timeline_finish(timeline);
+}
+
+/**
+ * Writes everything a run on one cpu that stopped before tick reports, the
+ * finishing time being the tick its last process terminated at, the cpu not
+ * counted as idle at the one tick after it
+ */
+/**
+ * Chains the timeline in front of the run's event sinks, so its statuses
+ * follow the run from here on. run_scheduler takes it back out once the
+ * engine returns
+ */
+void subscribe_timeline(SchedulerContext *context, Timeline *timeline) {
+    if (timeline->mode == TIMELINE_NONE) {
+        return;
+    }
+    timeline->sink.next = context->events;
+    context->events = &timeline->sink;
+}
+
+void report_results(SchedulerContext *context, Timeline *timeline, int tick, int not_utilized_count) {
+    tick -= 2;
+    not_utilized_count -= 1;
+    report_summary(context, timeline, tick, ((tick - not_utilized_count) * 1.0) / tick);
+    report_turnarounds(context, timeline);
+}
@@ -0,0 +1,119 @@
+/**
+ * Scheduler Context
+ */
+
+#ifndef SCHEDULERS_SCHEDULER_H
+#define SCHEDULERS_SCHEDULER_H
+#include <stdio.h>
+#include "process.h"
+#include "timeline.h"
+#include "instrument.h"
+#include "histogram.h"
+#include "sched_events.h"
+
+enum Algorithm {FCFS_ALGORITHM, RR_ALGORITHM, SJF_ALGORITHM, SRTF_ALGORITHM, PRIORITY_ALGORITHM, MLFQ_ALGORITHM};
+// FCFS and RR have tick and event engines of their own, any algorithm but MLFQ can run on the policy engine
+enum Engine {TICK_ENGINE, EVENT_ENGINE, POLICY_ENGINE};
+// what run_scheduler returns besides the checkpoint results rrr can give, see checkpoint.h
+enum RunResult {RUN_OK = 0, RUN_NO_MEMORY = -5};
+// goes up whenever a change to an engine changes what a run writes, so no cached result outlives it
+#define ENGINE_VERSION 1
+
+// everything one simulation run writes, so runs over the same workload can go side by side
+typedef struct SchedulerContext {
+    // the run's own copy of the processes, in the order of the list it was made from
+    Process *processes;
+    Process **process_list; // NULL terminated, NULL in a stream context
+    // the burst table the processes with burst lists decode theirs from, see bursts.h
+    const unsigned char *bursts;
+    int no_of_processes; // in a stream context the number of slots
+    // the status of processes[slot], kept in one array so per tick sweeps read contiguous ints
+    int *status;
+    // the tick processes[slot] was first dispatched at, -1 until then
+    int *first_run;
+    int now; // the tick the engine is at, for first_run
+    // what to run
+    int alg_type;
+    int quantum;
+    // multilevel feedback: its levels, the quantum of each, NULL for quantum doubling
+    // from one level to the next, and ticks between two priority boosts, 0 for none
+    int levels;
+    const int *level_quanta;
+    int boost_interval;
+    int engine;
+    int no_of_cpus; // more than one runs the policy engine on that many cpus
+    int host_threads; // threads a multi cpu run is spread over, a determinism check, see multicpu.c
+    // where the timeline and the summary go, NULL to only keep the results below
+    FILE *out;
+    OutputWriter *writer; // if set its thread writes to out, see pipeline.h
+    EventSink *events; // if set gets every scheduling event of the run, see sched_events.h
+    // rrr saves its state to checkpoint_file every checkpoint_interval ticks, see checkpoint.h
+    const char *checkpoint_file;
+    int checkpoint_interval;
+    const char *restore_file; // rrr starts from the state saved here instead of from tick 0
+    int timeline_mode;
+    int summary_format;
+    // results
+    int finishing_time;
+    double cpu_utilization;
+    double average_turnaround;
+    int max_turnaround;
+    int migrations; // processes stolen by another cpu, multi cpu runs only
+    // latency of every terminated process, in ticks
+    Histogram waiting_times;
+    Histogram response_times;
+    Histogram turnaround_times;
+    int latency_report; // write the histograms' summaries after the turnarounds
+} SchedulerContext;
+
+int status_event_type(const Process *process, int status);
+void report_status_event(SchedulerContext *context, Process *process, int status);
+
+// set_status without the event, for the multi cpu engine's per cpu phases that emit theirs later
+static inline void change_status(SchedulerContext *context, Process *process, int status) {
+    if (status == RUNNING && process->status != RUNNING) {
+        INSTRUMENT_COUNT(context_switches);
+    }
+    if (status == RUNNING && context->first_run[process - context->processes] < 0) {
+        context->first_run[process - context->processes] = context->now;
+    }
+    process->status = status;
+    context->status[process - context->processes] = status;
+}
+
+// the engines change a process's status only through here so status[] stays in step
+static inline void set_status(SchedulerContext *context, Process *process, int status) {
+    if (context->events != NULL && status != process->status) {
+        report_status_event(context, process, status);
+    }
+    change_status(context, process, status);
+}
+
+// for the events that aren't a status change, at the tick the engine is at
+static inline void report_event(SchedulerContext *context, int type, Process *process) {
+    if (context->events != NULL) {
+        emit_event(context->events, context->now, type, process->process_id, (int) (process - context->processes));
+    }
+}
+
+static inline void report_idle(SchedulerContext *context) {
+    if (context->events != NULL) {
+        emit_event(context->events, context->now, SCHED_IDLE, -1, -1);
+    }
+}
+
+int init_scheduler_context(SchedulerContext *context, Process **process_list, int no_of_processes);
+int init_stream_context(SchedulerContext *context, int capacity);
+void free_scheduler_context(SchedulerContext *context);
+int run_scheduler(SchedulerContext *context);
+const char* algorithm_name(int alg_type);
+
+// used by the engines to hand their summary to both the timeline and the context
+void report_summary(SchedulerContext *context, Timeline *timeline, int finishing_time, double utilization);
+void report_turnaround(SchedulerContext *context, Timeline *timeline, Process *process, int turnaround);
+void report_latency(SchedulerContext *context, Timeline *timeline);
+void report_turnarounds(SchedulerContext *context, Timeline *timeline);
+void report_results(SchedulerContext *context, Timeline *timeline, int tick, int not_utilized_count);
+void subscribe_timeline(SchedulerContext *context, Timeline *timeline);
+
+#endif //SCHEDULERS_SCHEDULER_H
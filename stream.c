@@ -0,0 +1,230 @@
+/**
+ * Streaming Engine
+ *
+ * The policy engine's tick loop over a text workload that is read as the
+ * simulated time reaches each arrival, so the input never has to be in
+ * memory at once. A process only holds one of the context's slots while it is
+ * in the system: it takes a free one when it arrives, and when it terminates
+ * its turnaround is written and the slot goes back. Memory and the work per
+ * tick follow the processes in the system, not the length of the input.
+ *
+ * The input has to be ordered by arrival time, processes arriving at the same
+ * tick may come in any order and are taken in by process id like load_workload
+ * orders them.
+ *
+ * Pipelined, a parser thread reads the input ahead of the simulation and hands
+ * the processes over through a ring, and with the context's writer set the
+ * output is written by a third thread, so reading, simulating and writing
+ * overlap.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "stream.h"
+
+// a process as the parser thread hands it over, with the line it was read from
+typedef struct ParsedProcess {
+    Process process;
+    int line_no;
+} ParsedProcess;
+
+// where run_stream takes the processes from, the input itself or the parser thread's ring
+typedef struct StreamReader {
+    WorkloadStream *input;
+    int threaded;
+    SpscRing ring;
+    pthread_t thread;
+    int line_no; // of the last process taken
+} StreamReader;
+
+static void* parser_thread(void *arg) {
+    StreamReader *reader = arg;
+    ParsedProcess parsed;
+    while (read_streamed_process(reader->input, &parsed.process)) {
+        parsed.line_no = reader->input->line_no;
+        if (!spsc_push(&reader->ring, &parsed)) {
+            // the simulation stopped early
+            break;
+        }
+    }
+    spsc_close(&reader->ring);
+    INSTRUMENT_MERGE_THREAD();
+    return NULL;
+}
+
+// reads on the calling thread if the parser thread can't be started
+static void start_reader(StreamReader *reader, WorkloadStream *input, int pipelined) {
+    reader->input = input;
+    reader->threaded = 0;
+    reader->line_no = input->line_no;
+    if (pipelined && init_spsc_ring(&reader->ring, STREAM_RING_SIZE, sizeof(ParsedProcess))) {
+        if (pthread_create(&reader->thread, NULL, parser_thread, reader) == 0) {
+            reader->threaded = 1;
+        } else {
+            free_spsc_ring(&reader->ring);
+        }
+    }
+}
+
+static int next_process(StreamReader *reader, Process *process) {
+    ParsedProcess parsed;
+    if (!reader->threaded) {
+        int read = read_streamed_process(reader->input, process);
+        reader->line_no = reader->input->line_no;
+        return read;
+    }
+    if (!spsc_pop(&reader->ring, &parsed)) {
+        return 0;
+    }
+    *process = parsed.process;
+    reader->line_no = parsed.line_no;
+    return 1;
+}
+
+// leaves the input's line_no at the line of the last process taken
+static void stop_reader(StreamReader *reader) {
+    if (reader->threaded) {
+        spsc_abandon(&reader->ring);
+        pthread_join(reader->thread, NULL);
+        free_spsc_ring(&reader->ring);
+    }
+    reader->input->line_no = reader->line_no;
+}
+
+/**
+ * Runs the processes read from input under the context's policy on one cpu,
+ * writing every turnaround as the process terminates and the finishing time
+ * and utilization at the end. There are no per tick lines, they would be
+ * interleaved with the turnarounds.
+ * returns STREAM_OK, STREAM_FULL if more processes than the context has slots
+ * were in the system at once, STREAM_UNORDERED if an arrival went back in time,
+ * the input's line_no then being the line of the process that did, or
+ * STREAM_NO_MEMORY if there is not enough memory for the run
+ */
+int run_stream(SchedulerContext *context, WorkloadStream *input, int pipelined) {
+    const Policy *policy = find_policy(context->alg_type);
+    int capacity = context->no_of_processes;
+    Timeline timeline;
+    timeline_init(&timeline, context->out, FCFS_TIMELINE, TIMELINE_NONE, context->summary_format,
+                  NULL, context->status, 0);
+    timeline.writer = context->writer;
+    timeline_start_results(&timeline);
+
+    ReadyQueue queue;
+    int allocated = init_ready_queue(&queue, capacity + 1, context->quantum);
+
+    BlockedSet blocked;
+    allocated &= init_blocked_set(&blocked, capacity);
+
+    // free slots are taken from the end, the lowest slots first
+    int *free_slots = malloc(sizeof(int) * (capacity + 1));
+    int free_count = 0;
+    while (free_slots != NULL && free_count < capacity) {
+        free_slots[free_count] = capacity - 1 - free_count;
+        free_count++;
+    }
+
+    Process **to_be_enqued = malloc(sizeof(Process*) * (capacity + 1));
+    Process **woken = malloc(sizeof(Process*) * (capacity + 1));
+    Process **ready = malloc(sizeof(Process*) * (capacity + 1));
+    INSTRUMENT_ADD(allocations, 4);
+    int to_be_enqued_count;
+    if (!allocated || free_slots == NULL || to_be_enqued == NULL || woken == NULL || ready == NULL) {
+        timeline_finish(&timeline);
+        free_ready_queue(&queue);
+        free_blocked_set(&blocked);
+        free(free_slots);
+        free(to_be_enqued);
+        free(woken);
+        free(ready);
+        return STREAM_NO_MEMORY;
+    }
+
+    StreamReader reader;
+    start_reader(&reader, input, pipelined);
+    Process pending;
+    int has_pending = next_process(&reader, &pending);
+
+    PolicyCpu cpu = {NULL, 0, 0};
+    Process *terminated;
+    int active_count = 0, result = STREAM_OK;
+    int tick = 0;
+    int slot;
+
+    while (has_pending || active_count > 0) {
+        context->now = tick;
+        INSTRUMENT_BEGIN(ARRIVAL_TIMING);
+        to_be_enqued_count = 0;
+        while (has_pending && pending.arrival_time <= tick) {
+            if (pending.arrival_time < 0) {
+                // never arrives, like in a loaded workload its turnaround stays 0
+                report_turnaround(context, &timeline, &pending, 0);
+            } else if (pending.arrival_time < tick) {
+                result = STREAM_UNORDERED;
+                break;
+            } else if (free_count == 0) {
+                result = STREAM_FULL;
+                break;
+            } else {
+                slot = free_slots[--free_count];
+                Process *process = &context->processes[slot];
+                *process = pending;
+                context->first_run[slot] = -1;
+                process->turnaround = tick;
+                set_status(context, process, READY);
+                to_be_enqued[to_be_enqued_count++] = process;
+                active_count++;
+            }
+            has_pending = next_process(&reader, &pending);
+        }
+        INSTRUMENT_END(ARRIVAL_TIMING);
+        if (result != STREAM_OK) {
+            break;
+        }
+
+        sort_process_list_by_id(to_be_enqued, to_be_enqued_count);
+        terminated = policy_tick(context, policy, &queue, &blocked, &cpu, to_be_enqued, to_be_enqued_count,
+                                 woken, ready, tick);
+        if (terminated != NULL) {
+            // written out and its slot given back right away
+            report_turnaround(context, &timeline, terminated, terminated->turnaround);
+            set_status(context, terminated, NONE);
+            free_slots[free_count++] = (int) (terminated - context->processes);
+            active_count--;
+        }
+        if (queue.no_memory) {
+            result = STREAM_NO_MEMORY;
+            break;
+        }
+        tick++;
+
+        if (cpu.running == NULL && is_ready_queue_empty(&queue) && blocked.count == 0 && !has_pending) {
+            // nothing left that could ever change the state
+            break;
+        }
+    }
+
+    if (result == STREAM_OK) {
+        // processes stuck in the system for good keep their arrival tick, as in run_policy
+        for (slot = 0; slot < capacity; slot++) {
+            if (context->status[slot] != NONE) {
+                report_turnaround(context, &timeline, &context->processes[slot],
+                                  context->processes[slot].turnaround);
+            }
+        }
+        tick -= 2;
+        cpu.not_utilized_count -= 1;
+        report_summary(context, &timeline, tick, ((tick - cpu.not_utilized_count) * 1.0) / tick);
+        report_latency(context, &timeline);
+    }
+    timeline_finish(&timeline);
+    stop_reader(&reader);
+
+    free_ready_queue(&queue);
+    free_blocked_set(&blocked);
+    free(free_slots);
+    free(to_be_enqued);
+    free(woken);
+    free(ready);
+    return result;
+}
@@ -0,0 +1,19 @@
+/**
+ * Streaming Engine
+ */
+
+#ifndef SCHEDULERS_STREAM_H
+#define SCHEDULERS_STREAM_H
+#include "loader.h"
+#include "policy.h"
+
+// the default number of processes a streamed run can hold at once
+#define DEFAULT_MAX_ACTIVE (1 << 16)
+// processes the parser thread of a pipelined run reads ahead at most
+#define STREAM_RING_SIZE 4096
+
+enum StreamResult {STREAM_OK = 0, STREAM_FULL = -1, STREAM_UNORDERED = -2, STREAM_NO_MEMORY = -3};
+
+int run_stream(SchedulerContext *context, WorkloadStream *input, int pipelined);
+
+#endif //SCHEDULERS_STREAM_H
@@ -0,0 +1,372 @@
+/**
+ * Parameter Sweep
+ *
+ * Runs many scheduler configurations over one workload on a pool of threads.
+ * The workload is only read, every run simulates its own SchedulerContext
+ * copy of it. Workers take the next run from a shared counter, so slow runs
+ * don't hold up the runs queued behind them.
+ *
+ * With a shared prefix, the RR runs on the tick and event engines are run as
+ * one: rrr goes the same way under every quantum until, at some tick, the
+ * process that has been running is preempted under the smaller quanta and not
+ * under the larger ones. Only there is the run copied, the copy going on for
+ * the larger quanta and the run itself for the smaller ones, each splitting
+ * again where its own quanta part ways.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "sweep.h"
+#include "fcfs.h"
+
+typedef struct SweepJob {
+    Process **process_list;
+    const unsigned char *bursts;
+    int no_of_processes;
+    SweepRun *runs;
+    int no_of_runs;
+    int next_run;
+    int shared_prefix;
+    int prefix_claimed; // a worker has taken the shared prefix runs
+    pthread_mutex_t lock;
+} SweepJob;
+
+/* An rrr run between two of its steps, standing for the runs [first, last)
+ * of a list of runs ordered by quantum
+ */
+typedef struct RrBranch {
+    SchedulerContext context; // its own processes, no output
+    RrState state; // pointing at the queues below
+    ProcessQueue queue;
+    BlockedSet blocked;
+    ArrivalIndex arrivals;
+    int first;
+    int last;
+} RrBranch;
+
+// fills in run from the results the context was left with
+static void record_results(SchedulerContext *context, SweepRun *run) {
+    run->failed = 0;
+    run->finishing_time = context->finishing_time;
+    run->cpu_utilization = context->cpu_utilization;
+    run->average_turnaround = context->average_turnaround;
+    run->max_turnaround = context->max_turnaround;
+    summarize_histogram(&context->waiting_times, &run->waiting);
+    summarize_histogram(&context->response_times, &run->response);
+    summarize_histogram(&context->turnaround_times, &run->turnaround);
+}
+
+static void run_one(SweepJob *job, SweepRun *run) {
+    SchedulerContext context;
+    if (!init_scheduler_context(&context, job->process_list, job->no_of_processes)) {
+        run->failed = 1;
+        return;
+    }
+    context.alg_type = run->alg_type;
+    context.quantum = run->quantum;
+    context.engine = run->engine;
+    context.bursts = job->bursts;
+    if (run_scheduler(&context) < 0) {
+        run->failed = 1;
+    } else {
+        record_results(&context, run);
+    }
+    free_scheduler_context(&context);
+}
+
+static void free_branch(RrBranch *b) {
+    free_process_queue(&b->queue);
+    free_blocked_set(&b->blocked);
+    free_arrival_index(&b->arrivals);
+    free_scheduler_context(&b->context);
+}
+
+// returns 1, or 0 if there is not enough memory
+static int init_branch(RrBranch *b, SweepJob *job) {
+    int allocated;
+    memset(b, 0, sizeof(RrBranch));
+    if (!init_scheduler_context(&b->context, job->process_list, job->no_of_processes)) {
+        return 0;
+    }
+    b->context.alg_type = RR_ALGORITHM;
+    b->context.bursts = job->bursts;
+    allocated = init_process_queue(&b->queue, job->no_of_processes + 1);
+    allocated &= init_blocked_set(&b->blocked, job->no_of_processes);
+    allocated &= build_arrival_index(&b->arrivals, b->context.process_list, job->no_of_processes);
+    if (!allocated) {
+        free_branch(b);
+        return 0;
+    }
+    b->state.queue = &b->queue;
+    b->state.blocked = &b->blocked;
+    b->state.arrivals = &b->arrivals;
+    return 1;
+}
+
+// the same process in another branch's copy of the processes
+static Process* rebase(Process *process, RrBranch *from, RrBranch *to) {
+    return process == NULL ? NULL : to->context.processes + (process - from->context.processes);
+}
+
+/**
+ * Copies b into a new branch with processes, queues and arrival index of
+ * its own
+ * returns the copy, or NULL if there is not enough memory
+ */
+static RrBranch* fork_branch(RrBranch *b) {
+    int i, n = b->context.no_of_processes;
+    RrBranch *fork = malloc(sizeof(RrBranch));
+    INSTRUMENT_COUNT(allocations);
+    if (fork == NULL) {
+        return NULL;
+    }
+    *fork = *b;
+    fork->context.processes = malloc(sizeof(Process) * ((size_t) n + 1));
+    fork->context.process_list = malloc(sizeof(Process*) * ((size_t) n + 1));
+    fork->context.status = malloc(sizeof(int) * ((size_t) n + 1));
+    fork->context.first_run = malloc(sizeof(int) * ((size_t) n + 1));
+    fork->queue.slots = malloc(sizeof(Process*) * b->queue.capacity);
+    fork->blocked.heap = malloc(sizeof(BlockedEntry) * b->blocked.capacity);
+    fork->arrivals.order = malloc(sizeof(Process*) * ((size_t) n + 1));
+    INSTRUMENT_ADD(allocations, 7);
+    if (fork->context.processes == NULL || fork->context.process_list == NULL || fork->context.status == NULL ||
+        fork->context.first_run == NULL || fork->queue.slots == NULL || fork->blocked.heap == NULL ||
+        fork->arrivals.order == NULL) {
+        free_branch(fork);
+        free(fork);
+        return NULL;
+    }
+    memcpy(fork->context.processes, b->context.processes, sizeof(Process) * n);
+    memcpy(fork->context.status, b->context.status, sizeof(int) * n);
+    memcpy(fork->context.first_run, b->context.first_run, sizeof(int) * n);
+    for (i = 0; i < n; i++) {
+        fork->context.process_list[i] = &fork->context.processes[i];
+    }
+    fork->context.process_list[n] = NULL;
+    // the queue is unwrapped, rrr can have put a NULL in it
+    fork->queue.head = 0;
+    for (i = 0; i < b->queue.count; i++) {
+        fork->queue.slots[i] = rebase(b->queue.slots[(b->queue.head + i) % b->queue.capacity], b, fork);
+    }
+    for (i = 0; i < b->blocked.count; i++) {
+        fork->blocked.heap[i] = b->blocked.heap[i];
+        fork->blocked.heap[i].process = rebase(b->blocked.heap[i].process, b, fork);
+    }
+    for (i = 0; i <= n; i++) {
+        fork->arrivals.order[i] = rebase(b->arrivals.order[i], b, fork);
+    }
+    fork->state.running = rebase(b->state.running, b, fork);
+    fork->state.queue = &fork->queue;
+    fork->state.blocked = &fork->blocked;
+    fork->state.arrivals = &fork->arrivals;
+    return fork;
+}
+
+// fills in the results of a finished branch, reported the way rrr reports them
+static void record_branch(RrBranch *b, SweepRun *run) {
+    Timeline timeline;
+    timeline_init(&timeline, NULL, RR_TIMELINE, TIMELINE_NONE, SUMMARY_TEXT, NULL, NULL, 0);
+    b->context.average_turnaround = 0;
+    b->context.max_turnaround = 0;
+    histogram_init(&b->context.waiting_times);
+    histogram_init(&b->context.response_times);
+    histogram_init(&b->context.turnaround_times);
+    report_rr_results(&b->context, &timeline, &b->state);
+    record_results(&b->context, run);
+}
+
+/**
+ * Runs b to the end for its runs with rrr's own step, splitting off a copy
+ * for the runs with the larger quanta whenever the running process is
+ * preempted under some of the quanta only
+ */
+static void run_branch(RrBranch *b, SweepRun **runs, Process **to_be_enqued, Process **io_done) {
+    int split, i;
+    while (b->state.finished_count < b->context.no_of_processes) {
+        // preempted under the quanta up to the run time, the runs before split
+        split = b->first;
+        while (split < b->last && runs[split]->quantum <= b->state.run_time) {
+            split++;
+        }
+        if (split > b->first && split < b->last) {
+            RrBranch *fork = fork_branch(b);
+            if (fork != NULL) {
+                fork->first = split;
+                run_branch(fork, runs, to_be_enqued, io_done);
+                free_branch(fork);
+                free(fork);
+            } else {
+                for (i = split; i < b->last; i++) {
+                    runs[i]->failed = 1;
+                }
+            }
+            b->last = split;
+        }
+        b->context.quantum = runs[b->first]->quantum;
+        if (rrr_step(&b->context, &b->state, NULL, to_be_enqued, io_done) < 0) {
+            for (i = b->first; i < b->last; i++) {
+                runs[i]->failed = 1;
+            }
+            return;
+        }
+    }
+    for (i = b->first; i < b->last; i++) {
+        record_branch(b, runs[i]);
+    }
+}
+
+// the runs whose results run_branch gives
+static int is_shared_prefix_run(SweepRun *run) {
+    return run->alg_type == RR_ALGORITHM && run->engine != POLICY_ENGINE;
+}
+
+static int compare_quantum(const void *a, const void *b) {
+    int first = (*(SweepRun* const*) a)->quantum, second = (*(SweepRun* const*) b)->quantum;
+    return first < second ? -1 : first > second;
+}
+
+static void run_shared_prefix(SweepJob *job) {
+    int i, count = 0;
+    SweepRun **runs = malloc(sizeof(SweepRun*) * job->no_of_runs);
+    Process **to_be_enqued = malloc(sizeof(Process*) * ((size_t) job->no_of_processes + 1));
+    Process **io_done = malloc(sizeof(Process*) * ((size_t) job->no_of_processes + 1));
+    RrBranch b;
+    INSTRUMENT_ADD(allocations, 3);
+    for (i = 0; runs != NULL && i < job->no_of_runs; i++) {
+        if (is_shared_prefix_run(&job->runs[i])) {
+            runs[count++] = &job->runs[i];
+        }
+    }
+    if (runs == NULL || to_be_enqued == NULL || io_done == NULL ||
+        !init_branch(&b, job)) {
+        for (i = 0; i < job->no_of_runs; i++) {
+            if (is_shared_prefix_run(&job->runs[i])) {
+                job->runs[i].failed = 1;
+            }
+        }
+    } else {
+        qsort(runs, count, sizeof(SweepRun*), compare_quantum);
+        b.first = 0;
+        b.last = count;
+        run_branch(&b, runs, to_be_enqued, io_done);
+        free_branch(&b);
+    }
+    free(runs);
+    free(to_be_enqued);
+    free(io_done);
+}
+
+static void* sweep_worker(void *arg) {
+    SweepJob *job = arg;
+    int next, shared;
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        next = job->next_run++;
+        // the first shared prefix run taken stands for all of them, the others are skipped
+        shared = next < job->no_of_runs && job->shared_prefix && is_shared_prefix_run(&job->runs[next]);
+        if (shared && job->prefix_claimed) {
+            pthread_mutex_unlock(&job->lock);
+            continue;
+        }
+        job->prefix_claimed |= shared;
+        pthread_mutex_unlock(&job->lock);
+        if (next >= job->no_of_runs) {
+            INSTRUMENT_MERGE_THREAD();
+            return NULL;
+        }
+        if (shared) {
+            run_shared_prefix(job);
+        } else {
+            run_one(job, &job->runs[next]);
+        }
+    }
+}
+
+/**
+ * Runs every configuration in runs over the process list, whose burst lists
+ * are in bursts or NULL if it has none, with no_of_threads
+ * threads or one per online cpu if it is 0 or less, the RR runs off the
+ * policy engine sharing their common prefix if shared_prefix is set
+ * returns the number of runs that failed
+ */
+int run_sweep(Process **process_list, const unsigned char *bursts, int no_of_processes, SweepRun *runs,
+              int no_of_runs, int no_of_threads, int shared_prefix) {
+    SweepJob job;
+    pthread_t *threads;
+    int i, started, failed = 0;
+
+    if (no_of_threads <= 0) {
+        no_of_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (no_of_threads > no_of_runs) {
+        no_of_threads = no_of_runs;
+    }
+    if (no_of_threads < 1) {
+        no_of_threads = 1;
+    }
+
+    job.process_list = process_list;
+    job.bursts = bursts;
+    job.no_of_processes = no_of_processes;
+    job.runs = runs;
+    job.no_of_runs = no_of_runs;
+    job.next_run = 0;
+    job.shared_prefix = shared_prefix;
+    job.prefix_claimed = 0;
+    pthread_mutex_init(&job.lock, NULL);
+
+    // the calling thread is a worker too
+    threads = malloc(sizeof(pthread_t) * no_of_threads);
+    for (started = 0; threads != NULL && started < no_of_threads - 1; started++) {
+        if (pthread_create(&threads[started], NULL, sweep_worker, &job) != 0) {
+            break;
+        }
+    }
+    sweep_worker(&job);
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&job.lock);
+
+    for (i = 0; i < no_of_runs; i++) {
+        failed += runs[i].failed;
+    }
+    return failed;
+}
+
+static void write_latency_header(FILE *out, const char *key) {
+    fprintf(out, ",%s_mean,%s_p50,%s_p90,%s_p99,%s_p99.9,%s_max", key, key, key, key, key, key);
+}
+
+static void write_latency(FILE *out, LatencySummary *latency) {
+    fprintf(out, ",%f,%d,%d,%d,%d,%d", latency->mean, latency->p50, latency->p90, latency->p99,
+            latency->p999, latency->max);
+}
+
+/**
+ * Writes the results as csv, one row per run in the order they were given
+ */
+void write_sweep_table(FILE *out, SweepRun *runs, int no_of_runs) {
+    int i;
+    fprintf(out, "algorithm,quantum,finishing_time,cpu_utilization,average_turnaround,max_turnaround");
+    write_latency_header(out, "waiting");
+    write_latency_header(out, "response");
+    write_latency_header(out, "turnaround");
+    fprintf(out, "\n");
+    for (i = 0; i < no_of_runs; i++) {
+        SweepRun *run = &runs[i];
+        if (run->failed) {
+            fprintf(out, "%s,%d,,,,,,,,,,,,,,,,,,,,,,\n", algorithm_name(run->alg_type), run->quantum);
+            continue;
+        }
+        fprintf(out, "%s,%d,%d,%f,%f,%d", algorithm_name(run->alg_type), run->quantum,
+                run->finishing_time, run->cpu_utilization, run->average_turnaround, run->max_turnaround);
+        write_latency(out, &run->waiting);
+        write_latency(out, &run->response);
+        write_latency(out, &run->turnaround);
+        fprintf(out, "\n");
+    }
+}
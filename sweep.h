@@ -0,0 +1,29 @@
+/**
+ * Parameter Sweep
+ */
+
+#ifndef SCHEDULERS_SWEEP_H
+#define SCHEDULERS_SWEEP_H
+#include <stdio.h>
+#include "scheduler.h"
+
+// one run of a sweep, alg_type, quantum and engine are read, the rest is filled in
+typedef struct SweepRun {
+    int alg_type;
+    int quantum;
+    int engine;
+    int failed; // 1 if the run couldn't get the memory for its context
+    int finishing_time;
+    double cpu_utilization;
+    double average_turnaround;
+    int max_turnaround;
+    LatencySummary waiting;
+    LatencySummary response;
+    LatencySummary turnaround;
+} SweepRun;
+
+int run_sweep(Process **process_list, const unsigned char *bursts, int no_of_processes, SweepRun *runs,
+              int no_of_runs, int no_of_threads, int shared_prefix);
+void write_sweep_table(FILE *out, SweepRun *runs, int no_of_runs);
+
+#endif //SCHEDULERS_SWEEP_H
@@ -0,0 +1,133 @@
+/**
+ * Burst List Test
+ *
+ * Processes with burst lists must run the whole list on every engine: the
+ * event engines with the output of the tick engines, and every algorithm on
+ * the policy engine, on one cpu or several, blocking once for every io burst
+ * that isn't empty and terminating after the last cpu burst.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+
+// two processes whose lists go on well past their first cpu, io, cpu, finishing at tick 19
+static const char listed[] =
+    "0 2 3 0 0 1 4 5 2 1\n"
+    "1 1 1 1 0 3 2 1\n";
+// the io bursts of listed that aren't empty
+#define LISTED_BLOCKS 5
+
+static const char *engine_names[] = {"tick", "event", "policy"};
+
+// the BLOCK and TERMINATE events of a run
+typedef struct BurstCounts {
+    int blocks;
+    int terminates;
+} BurstCounts;
+
+static void count_burst_event(const SchedEvent *event, void *data) {
+    BurstCounts *counts = data;
+    if (event->type == SCHED_BLOCK) {
+        counts->blocks++;
+    } else if (event->type == SCHED_TERMINATE) {
+        counts->terminates++;
+    }
+}
+
+// the tick and event engines must write the same
+
+static void compare_engines(const char *name, Workload *workload, int alg_type, int quantum, int finishing_time) {
+    SchedulerContext context;
+    char *tick, *other;
+    int engine;
+    init_test_context(&context, workload, alg_type, quantum, TICK_ENGINE);
+    tick = run_to_memory(&context);
+    free_scheduler_context(&context);
+    if (tick == NULL) {
+        check(0, "%s %s q=%d could not run", name, algorithm_name(alg_type), quantum);
+        return;
+    }
+    for (engine = TICK_ENGINE; engine <= EVENT_ENGINE; engine++) {
+        init_test_context(&context, workload, alg_type, quantum, engine);
+        other = run_to_memory(&context);
+        check(other != NULL && strcmp(tick, other) == 0, "%s %s q=%d: %s engine output differs from the tick engine's",
+              name, algorithm_name(alg_type), quantum, engine_names[engine]);
+        check(finishing_time < 0 || context.finishing_time == finishing_time,
+              "%s %s q=%d: %s engine finished at %d instead of %d", name, algorithm_name(alg_type), quantum,
+              engine_names[engine], context.finishing_time, finishing_time);
+        free_scheduler_context(&context);
+        free(other);
+    }
+    free(tick);
+}
+
+/**
+ * Runs the algorithm on the policy engine on no_of_cpus cpus, which must
+ * block blocks times all told and terminate every process
+ */
+static void follow_lists(const char *name, Workload *workload, int alg_type, int no_of_cpus, int blocks) {
+    SchedulerContext context;
+    EventSink sink;
+    BurstCounts counts = {0, 0};
+    char *output;
+    init_test_context(&context, workload, alg_type, 2, POLICY_ENGINE);
+    context.no_of_cpus = no_of_cpus;
+    init_event_sink(&sink, count_burst_event, &counts, NULL);
+    context.events = &sink;
+    output = run_to_memory(&context);
+    check(output != NULL, "%s %s on %d cpus could not run", name, algorithm_name(alg_type), no_of_cpus);
+    check(counts.blocks == blocks, "%s %s on %d cpus blocked %d times instead of %d", name,
+          algorithm_name(alg_type), no_of_cpus, counts.blocks, blocks);
+    check(counts.terminates == workload->no_of_processes, "%s %s on %d cpus terminated %d of %d processes", name,
+          algorithm_name(alg_type), no_of_cpus, counts.terminates, workload->no_of_processes);
+    free_scheduler_context(&context);
+    free(output);
+}
+
+static void test_workload(const char *name, const char *file_name, int finishing_time, int blocks) {
+    Workload workload;
+    int alg_type;
+    if (!load_test_workload(&workload, file_name)) {
+        check(0, "%s could not be loaded", name);
+        return;
+    }
+    check(workload.bursts.length > 0, "%s has no burst lists", name);
+    compare_engines(name, &workload, FCFS_ALGORITHM, 1, finishing_time);
+    compare_engines(name, &workload, RR_ALGORITHM, 1, -1);
+    compare_engines(name, &workload, RR_ALGORITHM, 3, -1);
+    for (alg_type = FCFS_ALGORITHM; alg_type <= MLFQ_ALGORITHM; alg_type++) {
+        follow_lists(name, &workload, alg_type, 1, blocks);
+        if (alg_type != MLFQ_ALGORITHM) {
+            follow_lists(name, &workload, alg_type, 2, blocks);
+        }
+    }
+    free_workload(&workload);
+}
+
+int main(void) {
+    char file_name[TEST_FILE_NAME_SIZE], name[64];
+    unsigned int seed;
+    int blocks;
+
+    if (write_text_file(file_name, listed)) {
+        test_workload("listed", file_name, 19, LISTED_BLOCKS);
+        unlink(file_name);
+    } else {
+        check(0, "listed could not be written");
+    }
+    for (seed = 1; seed <= 4; seed++) {
+        snprintf(name, sizeof(name), "seed %u", seed);
+        if (!write_listed_workload(file_name, seed, 40, &blocks)) {
+            check(0, "%s could not be written", name);
+            continue;
+        }
+        test_workload(name, file_name, -1, blocks);
+        unlink(file_name);
+    }
+    if (test_failures == 0) {
+        printf("bursts_test passed\n");
+    }
+    return test_failures == 0 ? 0 : 1;
+}
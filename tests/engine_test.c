@@ -0,0 +1,92 @@
+/**
+ * Engine Test
+ *
+ * The event engines are an optimisation of the tick engines, so FCFS and RR
+ * must write exactly the same timeline and summary on both, for seeded
+ * workloads of either arrival pattern and a few quanta. A multi cpu run must
+ * write the same whatever the number of host threads it is spread over.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "../generator.h"
+
+static void compare_engines(const char *name, Workload *workload, int alg_type, int quantum) {
+    SchedulerContext context;
+    char *tick, *event;
+    init_test_context(&context, workload, alg_type, quantum, TICK_ENGINE);
+    tick = run_to_memory(&context);
+    free_scheduler_context(&context);
+    init_test_context(&context, workload, alg_type, quantum, EVENT_ENGINE);
+    event = run_to_memory(&context);
+    free_scheduler_context(&context);
+    check(tick != NULL && event != NULL, "%s %s q=%d could not run", name, algorithm_name(alg_type), quantum);
+    if (tick != NULL && event != NULL) {
+        check(strcmp(tick, event) == 0, "%s %s q=%d: event engine output differs from the tick engine's",
+              name, algorithm_name(alg_type), quantum);
+    }
+    free(tick);
+    free(event);
+}
+
+static void compare_host_threads(const char *name, Workload *workload, int alg_type) {
+    SchedulerContext context;
+    char *one, *several;
+    init_test_context(&context, workload, alg_type, 2, POLICY_ENGINE);
+    context.no_of_cpus = 4;
+    one = run_to_memory(&context);
+    free_scheduler_context(&context);
+    init_test_context(&context, workload, alg_type, 2, POLICY_ENGINE);
+    context.no_of_cpus = 4;
+    context.host_threads = 3;
+    several = run_to_memory(&context);
+    free_scheduler_context(&context);
+    check(one != NULL && several != NULL, "%s %s on 4 cpus could not run", name, algorithm_name(alg_type));
+    if (one != NULL && several != NULL) {
+        check(strcmp(one, several) == 0, "%s %s on 4 cpus: output differs over 3 host threads", name,
+              algorithm_name(alg_type));
+    }
+    free(one);
+    free(several);
+}
+
+static void test_workload(const char *name, const char *file_name) {
+    static const int quanta[] = {1, 2, 3, 7};
+    Workload workload;
+    int q;
+    if (!load_test_workload(&workload, file_name)) {
+        check(0, "%s could not be loaded", name);
+        return;
+    }
+    compare_engines(name, &workload, FCFS_ALGORITHM, 1);
+    for (q = 0; q < (int) (sizeof(quanta) / sizeof(quanta[0])); q++) {
+        compare_engines(name, &workload, RR_ALGORITHM, quanta[q]);
+    }
+    compare_host_threads(name, &workload, RR_ALGORITHM);
+    compare_host_threads(name, &workload, SRTF_ALGORITHM);
+    free_workload(&workload);
+}
+
+int main(void) {
+    char file_name[TEST_FILE_NAME_SIZE], name[64];
+    int seed, arrivals;
+
+    test_workload("sample/sample", "sample/sample");
+    for (seed = 1; seed <= 4; seed++) {
+        for (arrivals = POISSON_ARRIVALS; arrivals <= BURSTY_ARRIVALS; arrivals++) {
+            snprintf(name, sizeof(name), "%s seed %d", arrivals == POISSON_ARRIVALS ? "poisson" : "bursty", seed);
+            if (!write_workload(file_name, seed, 200, arrivals, seed % 2 ? UNIFORM_BURSTS : PARETO_BURSTS)) {
+                check(0, "%s could not be written", name);
+                continue;
+            }
+            test_workload(name, file_name);
+            unlink(file_name);
+        }
+    }
+    if (test_failures == 0) {
+        printf("engine_test passed\n");
+    }
+    return test_failures == 0 ? 0 : 1;
+}
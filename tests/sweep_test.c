@@ -0,0 +1,94 @@
+/**
+ * Sweep Test
+ *
+ * A sweep sharing the prefix of its RR runs must give every run the results
+ * it gets run on its own, however the runs split, for seeded workloads with
+ * and without burst lists.
+ */
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "../generator.h"
+#include "../sweep.h"
+
+#define NO_OF_QUANTA 8
+// FCFS, then RR for the quanta on the tick and the event engine
+#define NO_OF_RUNS (1 + 2 * NO_OF_QUANTA)
+
+static void init_runs(SweepRun *runs) {
+    int i;
+    runs[0].alg_type = FCFS_ALGORITHM;
+    runs[0].quantum = 1;
+    runs[0].engine = TICK_ENGINE;
+    for (i = 0; i < 2 * NO_OF_QUANTA; i++) {
+        runs[1 + i].alg_type = RR_ALGORITHM;
+        // out of order, the sweep sorts them by quantum
+        runs[1 + i].quantum = NO_OF_QUANTA - i % NO_OF_QUANTA;
+        runs[1 + i].engine = i < NO_OF_QUANTA ? TICK_ENGINE : EVENT_ENGINE;
+    }
+}
+
+static int same_latency(LatencySummary *a, LatencySummary *b) {
+    return a->mean == b->mean && a->p50 == b->p50 && a->p90 == b->p90 && a->p99 == b->p99 &&
+           a->p999 == b->p999 && a->max == b->max;
+}
+
+static void compare_sweeps(const char *name, Workload *workload) {
+    SweepRun alone[NO_OF_RUNS], shared[NO_OF_RUNS];
+    const unsigned char *bursts = workload->bursts.length > 0 ? workload->bursts.bytes : NULL;
+    int i;
+    init_runs(alone);
+    init_runs(shared);
+    check(run_sweep(workload->process_list, bursts, workload->no_of_processes, alone, NO_OF_RUNS, 2, 0) == 0,
+          "%s: a run on its own failed", name);
+    check(run_sweep(workload->process_list, bursts, workload->no_of_processes, shared, NO_OF_RUNS, 2, 1) == 0,
+          "%s: a shared prefix run failed", name);
+    for (i = 0; i < NO_OF_RUNS; i++) {
+        SweepRun *a = &alone[i], *s = &shared[i];
+        check(a->finishing_time == s->finishing_time && a->cpu_utilization == s->cpu_utilization &&
+              a->average_turnaround == s->average_turnaround && a->max_turnaround == s->max_turnaround,
+              "%s %s q=%d: the shared prefix summary differs", name, algorithm_name(a->alg_type), a->quantum);
+        check(same_latency(&a->waiting, &s->waiting) && same_latency(&a->response, &s->response) &&
+              same_latency(&a->turnaround, &s->turnaround),
+              "%s %s q=%d: the shared prefix latencies differ", name, algorithm_name(a->alg_type), a->quantum);
+    }
+}
+
+static void test_workload(const char *name, const char *file_name) {
+    Workload workload;
+    if (!load_test_workload(&workload, file_name)) {
+        check(0, "%s could not be loaded", name);
+        return;
+    }
+    compare_sweeps(name, &workload);
+    free_workload(&workload);
+}
+
+int main(void) {
+    char file_name[TEST_FILE_NAME_SIZE], name[64];
+    int seed, blocks;
+
+    test_workload("sample/sample", "sample/sample");
+    for (seed = 1; seed <= 4; seed++) {
+        snprintf(name, sizeof(name), "seed %d", seed);
+        if (!write_workload(file_name, seed, 200, seed % 2 ? POISSON_ARRIVALS : BURSTY_ARRIVALS, UNIFORM_BURSTS)) {
+            check(0, "%s could not be written", name);
+            continue;
+        }
+        test_workload(name, file_name);
+        unlink(file_name);
+
+        snprintf(name, sizeof(name), "listed seed %d", seed);
+        if (!write_listed_workload(file_name, seed, 60, &blocks)) {
+            check(0, "%s could not be written", name);
+            continue;
+        }
+        test_workload(name, file_name);
+        unlink(file_name);
+    }
+    if (test_failures == 0) {
+        printf("sweep_test passed\n");
+    }
+    return test_failures == 0 ? 0 : 1;
+}
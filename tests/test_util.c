@@ -0,0 +1,147 @@
+/**
+ * Test Helpers
+ */
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "../generator.h"
+
+int test_failures = 0;
+
+// prints the message of a check that did not pass
+void check(int passed, const char *format, ...) {
+    va_list args;
+    if (passed) {
+        return;
+    }
+    va_start(args, format);
+    printf("FAIL ");
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+    test_failures++;
+}
+
+static FILE* open_test_file(char *file_name) {
+    int fd;
+    strcpy(file_name, "/tmp/sched_test_XXXXXX");
+    fd = mkstemp(file_name);
+    return fd < 0 ? NULL : fdopen(fd, "w");
+}
+
+/**
+ * Generates a seeded workload into a new temporary file, its name left in file_name
+ * returns 0 if it could not be written
+ */
+int write_workload(char *file_name, uint64_t seed, long long no_of_processes, int arrivals, int bursts) {
+    GeneratorOptions options;
+    FILE *f = open_test_file(file_name);
+    if (f == NULL) {
+        return 0;
+    }
+    default_generator_options(&options);
+    options.seed = seed;
+    options.no_of_processes = no_of_processes;
+    options.arrivals = arrivals;
+    options.bursts = bursts;
+    generate_workload(f, &options);
+    fclose(f);
+    return 1;
+}
+
+// writes a processes info file given as text, returns 0 if it could not be written
+int write_text_file(char *file_name, const char *text) {
+    FILE *f = open_test_file(file_name);
+    if (f == NULL) {
+        return 0;
+    }
+    fputs(text, f);
+    fclose(f);
+    return 1;
+}
+
+/**
+ * Writes a seeded workload where most processes have burst lists of up to
+ * three more cpu and io bursts into a new temporary file, its name left in
+ * file_name and the io bursts that aren't empty counted in blocks
+ * returns 0 if it could not be written
+ */
+int write_listed_workload(char *file_name, unsigned int seed, int no_of_processes, int *blocks) {
+    char *text = NULL;
+    size_t text_length = 0;
+    FILE *out = open_memstream(&text, &text_length);
+    int i, k, io, written;
+    if (out == NULL) {
+        return 0;
+    }
+    srand(seed);
+    *blocks = 0;
+    for (i = 0; i < no_of_processes; i++) {
+        io = rand() % 7;
+        fprintf(out, "%d %d %d %d", i, 1 + rand() % 6, io, rand() % 40);
+        *blocks += io != 0;
+        if (rand() % 5 < 3) {
+            // the priority, then the list, ending with a cpu burst
+            fprintf(out, " %d", rand() % 6);
+            for (k = rand() % 4; k > 0; k--) {
+                io = rand() % 7;
+                fprintf(out, " %d %d", 1 + rand() % 6, io);
+                *blocks += io != 0;
+            }
+            fprintf(out, " %d", 1 + rand() % 6);
+        }
+        fprintf(out, "\n");
+    }
+    fclose(out);
+    written = write_text_file(file_name, text);
+    free(text);
+    return written;
+}
+
+// loads a processes info file sorted the way main sorts it, returns 0 if it could not be loaded
+int load_test_workload(Workload *workload, const char *file_name) {
+    if (load_workload(workload, file_name) != LOAD_OK) {
+        return 0;
+    }
+    if (!workload->sorted) {
+        sort_process_list(workload->process_list, workload->no_of_processes);
+    }
+    return 1;
+}
+
+// a context for one run over the workload with the full timeline and the text summary
+void init_test_context(SchedulerContext *context, Workload *workload, int alg_type, int quantum, int engine) {
+    init_scheduler_context(context, workload->process_list, workload->no_of_processes);
+    context->alg_type = alg_type;
+    context->quantum = quantum;
+    context->engine = engine;
+    context->timeline_mode = TIMELINE_FULL;
+    if (workload->bursts.length > 0) {
+        context->bursts = workload->bursts.bytes;
+    }
+}
+
+/**
+ * Runs the context with everything it writes kept in memory, its results are
+ * left in it for the caller to check before freeing it
+ * returns what the run wrote, to be freed by the caller, NULL if it could not run
+ */
+char* run_to_memory(SchedulerContext *context) {
+    char *output = NULL;
+    size_t output_length = 0;
+    context->out = open_memstream(&output, &output_length);
+    if (context->out == NULL) {
+        return NULL;
+    }
+    if (run_scheduler(context) < 0) {
+        fclose(context->out);
+        free(output);
+        return NULL;
+    }
+    fclose(context->out);
+    context->out = NULL;
+    return output;
+}
@@ -0,0 +1,27 @@
+/**
+ * Test Helpers
+ *
+ * What the regression tests under tests/ share: seeded workloads written to
+ * temporary files and runs whose whole output is kept in memory to compare.
+ */
+
+#ifndef SCHEDULERS_TEST_UTIL_H
+#define SCHEDULERS_TEST_UTIL_H
+#include <stdint.h>
+#include "../loader.h"
+#include "../scheduler.h"
+
+#define TEST_FILE_NAME_SIZE 32
+
+// every check that failed so far, a test exits with it
+extern int test_failures;
+
+void check(int passed, const char *format, ...);
+int write_workload(char *file_name, uint64_t seed, long long no_of_processes, int arrivals, int bursts);
+int write_text_file(char *file_name, const char *text);
+int write_listed_workload(char *file_name, unsigned int seed, int no_of_processes, int *blocks);
+int load_test_workload(Workload *workload, const char *file_name);
+void init_test_context(SchedulerContext *context, Workload *workload, int alg_type, int quantum, int engine);
+char* run_to_memory(SchedulerContext *context);
+
+#endif //SCHEDULERS_TEST_UTIL_H
@@ -0,0 +1,124 @@
+/**
+ * Timeline Test
+ *
+ * A delta or run-length timeline decoded with timeline_decode must be the
+ * full timeline of the same run, byte for byte, summary included. The
+ * timeline follows the run's events, a sink of the caller's next to it must
+ * neither change it nor miss any of them.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "../generator.h"
+
+static char* decode(const char *encoded) {
+    char *decoded = NULL;
+    size_t decoded_length = 0;
+    FILE *in = fmemopen((void *) encoded, strlen(encoded), "r");
+    FILE *out = open_memstream(&decoded, &decoded_length);
+    int result = in != NULL && out != NULL ? timeline_decode(in, out) : -1;
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+    if (result != 0) {
+        free(decoded);
+        return NULL;
+    }
+    return decoded;
+}
+
+static void count_event(const SchedEvent *event, void *data) {
+    (void) event;
+    (*(int *) data)++;
+}
+
+static void round_trip(const char *name, Workload *workload, int alg_type, int engine, int no_of_cpus) {
+    static const int modes[] = {TIMELINE_DELTA, TIMELINE_RUN_LENGTH};
+    SchedulerContext context;
+    EventSink sink;
+    char *full, *encoded, *decoded, *subscribed;
+    int m, events = 0;
+    init_test_context(&context, workload, alg_type, 3, engine);
+    context.no_of_cpus = no_of_cpus;
+    full = run_to_memory(&context);
+    free_scheduler_context(&context);
+    if (full == NULL) {
+        check(0, "%s %s could not run", name, algorithm_name(alg_type));
+        return;
+    }
+    for (m = 0; m < 2; m++) {
+        const char *mode_name = modes[m] == TIMELINE_DELTA ? "delta" : "rle";
+        init_test_context(&context, workload, alg_type, 3, engine);
+        context.no_of_cpus = no_of_cpus;
+        context.timeline_mode = modes[m];
+        encoded = run_to_memory(&context);
+        free_scheduler_context(&context);
+        decoded = encoded != NULL ? decode(encoded) : NULL;
+        check(decoded != NULL, "%s %s engine %d cpus %d: %s timeline could not be decoded", name,
+              algorithm_name(alg_type), engine, no_of_cpus, mode_name);
+        if (decoded != NULL) {
+            check(strcmp(full, decoded) == 0, "%s %s engine %d cpus %d: decoded %s timeline differs from the full one",
+                  name, algorithm_name(alg_type), engine, no_of_cpus, mode_name);
+        }
+        free(encoded);
+        free(decoded);
+    }
+
+    init_test_context(&context, workload, alg_type, 3, engine);
+    context.no_of_cpus = no_of_cpus;
+    init_event_sink(&sink, count_event, &events, NULL);
+    context.events = &sink;
+    subscribed = run_to_memory(&context);
+    check(subscribed != NULL && strcmp(full, subscribed) == 0,
+          "%s %s engine %d cpus %d: the timeline differs with another sink subscribed", name,
+          algorithm_name(alg_type), engine, no_of_cpus);
+    // every process at least arrives and terminates
+    check(events >= 2 * workload->no_of_processes && context.events == &sink,
+          "%s %s engine %d cpus %d: the caller's sink lost events or its place", name, algorithm_name(alg_type),
+          engine, no_of_cpus);
+    free_scheduler_context(&context);
+    free(subscribed);
+    free(full);
+}
+
+static void test_workload(const char *name, const char *file_name) {
+    Workload workload;
+    int alg_type;
+    if (!load_test_workload(&workload, file_name)) {
+        check(0, "%s could not be loaded", name);
+        return;
+    }
+    for (alg_type = FCFS_ALGORITHM; alg_type <= MLFQ_ALGORITHM; alg_type++) {
+        round_trip(name, &workload, alg_type, TICK_ENGINE, 1);
+    }
+    round_trip(name, &workload, FCFS_ALGORITHM, EVENT_ENGINE, 1);
+    round_trip(name, &workload, RR_ALGORITHM, EVENT_ENGINE, 1);
+    round_trip(name, &workload, RR_ALGORITHM, POLICY_ENGINE, 1);
+    round_trip(name, &workload, SRTF_ALGORITHM, POLICY_ENGINE, 3);
+    free_workload(&workload);
+}
+
+int main(void) {
+    char file_name[TEST_FILE_NAME_SIZE], name[64];
+    int seed;
+
+    test_workload("sample/sample", "sample/sample");
+    for (seed = 1; seed <= 3; seed++) {
+        snprintf(name, sizeof(name), "seed %d", seed);
+        if (!write_workload(file_name, seed, 150, seed == 2 ? BURSTY_ARRIVALS : POISSON_ARRIVALS, UNIFORM_BURSTS)) {
+            check(0, "%s could not be written", name);
+            continue;
+        }
+        test_workload(name, file_name);
+        unlink(file_name);
+    }
+    if (test_failures == 0) {
+        printf("timeline_test passed\n");
+    }
+    return test_failures == 0 ? 0 : 1;
+}
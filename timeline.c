@@ -0,0 +1,747 @@
+/**
+ * Timeline Writer
+ *
+ * Collects the per tick state lines of the schedulers in one big buffer and
+ * writes it out in chunks instead of one small write per process per tick.
+ * The shown processes are rendered into a cached line that is only rebuilt
+ * when one of them changes state, which also gives the delta and run-length
+ * modes their changes for free. The states come from the run's scheduling
+ * events, the timeline is one more subscriber to them.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "timeline.h"
+#include "instrument.h"
+
+static const char *state_names[] = {"running", "ready", "blocked"};
+
+// RUNNING, READY and BLOCKING are shown as they are, anything else is not shown
+static int shown_state(int status) {
+    return (unsigned int) status <= BLOCKING ? status : -1;
+}
+
+/* Without the memory for another chunk the writer is finished, which writes
+ * out the chunks it still holds, and the rest goes straight to the output,
+ * so nothing is written out of order
+ */
+static void stop_writer(Timeline *t) {
+    finish_output_writer(t->writer);
+    t->writer = NULL;
+}
+
+// without an output file everything written is dropped here
+static void flush_buffer(Timeline *t) {
+    if (t->length > 0 && t->writer != NULL) {
+        // the writer frees the buffer once it is written, the timeline goes on in a new one
+        char *buffer = malloc(TIMELINE_BUFFER_SIZE);
+        INSTRUMENT_COUNT(allocations);
+        if (buffer != NULL) {
+            write_output_chunk(t->writer, t->buffer, t->length);
+            t->buffer = buffer;
+        } else {
+            stop_writer(t);
+        }
+    }
+    if (t->length > 0 && t->writer == NULL && t->out != NULL) {
+        fwrite(t->buffer, 1, t->length, t->out);
+    }
+    t->length = 0;
+}
+
+static void append(Timeline *t, const char *data, size_t size) {
+    // without the memory for a buffer everything is written as it comes
+    if (t->buffer == NULL) {
+        if (t->writer != NULL) {
+            stop_writer(t);
+        }
+        if (t->out != NULL) {
+            fwrite(data, 1, size, t->out);
+        }
+        return;
+    }
+    if (size > TIMELINE_BUFFER_SIZE - t->length) {
+        flush_buffer(t);
+        if (size >= TIMELINE_BUFFER_SIZE) {
+            char *copy = NULL;
+            if (t->writer != NULL) {
+                copy = malloc(size);
+                INSTRUMENT_COUNT(allocations);
+                if (copy == NULL) {
+                    stop_writer(t);
+                }
+            }
+            if (copy != NULL) {
+                memcpy(copy, data, size);
+                write_output_chunk(t->writer, copy, size);
+            } else if (t->out != NULL) {
+                fwrite(data, 1, size, t->out);
+            }
+            return;
+        }
+    }
+    memcpy(t->buffer + t->length, data, size);
+    t->length += size;
+}
+
+static void append_string(Timeline *t, const char *s) {
+    append(t, s, strlen(s));
+}
+
+static void append_int(Timeline *t, int value) {
+    char digits[12];
+    int i = sizeof(digits);
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int) value : (unsigned int) value;
+    do {
+        digits[--i] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--i] = '-';
+    }
+    append(t, digits + i, sizeof(digits) - i);
+}
+
+static void line_append(Timeline *t, const char *s, size_t size) {
+    if (t->line_length + size + 1 > t->line_capacity) {
+        while (t->line_length + size + 1 > t->line_capacity) {
+            t->line_capacity *= 2;
+        }
+        t->line = realloc(t->line, t->line_capacity);
+        INSTRUMENT_COUNT(allocations);
+    }
+    memcpy(t->line + t->line_length, s, size);
+    t->line_length += size;
+}
+
+// rebuilds the shown slots and the cached line from the slot states
+static void render_line(Timeline *t) {
+    char id[16];
+    int slot, state;
+    if (!t->line_dirty) {
+        return;
+    }
+    t->shown_count = 0;
+    t->line_length = 0;
+    for (slot = 0; slot < t->no_of_processes; slot++) {
+        state = t->states[slot];
+        if (state == -1) {
+            continue;
+        }
+        t->shown[t->shown_count++] = slot;
+        line_append(t, id, sprintf(id, "%d: ", t->ids[slot]));
+        line_append(t, state_names[state], strlen(state_names[state]));
+        line_append(t, " ", 1);
+    }
+    t->line_dirty = 0;
+}
+
+// writes one tick in the full format from the slot states
+static void write_full_line(Timeline *t, int tick) {
+    int i, slot;
+    render_line(t);
+    if (t->style == FCFS_TIMELINE) {
+        append_int(t, tick);
+        append(t, ": ", 2);
+        append(t, t->line, t->line_length);
+    } else {
+        for (i = 0; i < t->shown_count; i++) {
+            slot = t->shown[i];
+            append_int(t, tick);
+            append(t, " | ", 3);
+            append_int(t, t->ids[slot]);
+            append(t, ": ", 2);
+            append_string(t, state_names[t->states[slot]]);
+            append(t, " ", 1);
+        }
+    }
+    append(t, "\n", 1);
+}
+
+static void write_run(Timeline *t) {
+    if (t->run_start == -1) {
+        return;
+    }
+    render_line(t);
+    append_int(t, t->run_start);
+    append(t, "-", 1);
+    append_int(t, t->last_tick);
+    append(t, ": ", 2);
+    append(t, t->line, t->line_length);
+    append(t, "\n", 1);
+    t->run_start = -1;
+}
+
+// writes whatever the delta and run-length modes still hold back
+static void close_ticks(Timeline *t) {
+    if (t->mode == TIMELINE_RUN_LENGTH) {
+        write_run(t);
+    } else if (t->mode == TIMELINE_DELTA && t->last_written != t->last_tick) {
+        append_int(t, t->last_tick);
+        append(t, ":\n", 2);
+        t->last_written = t->last_tick;
+    }
+}
+
+static void grow_slots(Timeline *t, int no_of_processes) {
+    size_t size = sizeof(int) * ((size_t) no_of_processes + 1);
+    t->ids = realloc(t->ids, size);
+    t->states = realloc(t->states, size);
+    t->changed = realloc(t->changed, size);
+    t->shown = realloc(t->shown, size);
+    t->status = realloc(t->status, size);
+    INSTRUMENT_ADD(allocations, 5);
+}
+
+/* Keeps status where the run's events leave each process. rrr leaves a
+ * preempted process RUNNING while it waits in the queue, and its timeline
+ * has always shown it running until it gets the cpu back
+ */
+static void timeline_event(const SchedEvent *event, void *data) {
+    Timeline *t = data;
+    switch (event->type) {
+        case SCHED_DISPATCH:
+            t->status[event->slot] = RUNNING;
+            break;
+        case SCHED_PREEMPT:
+            if (t->style != RR_TIMELINE) {
+                t->status[event->slot] = READY;
+            }
+            break;
+        case SCHED_ARRIVE:
+        case SCHED_UNBLOCK:
+            t->status[event->slot] = READY;
+            break;
+        case SCHED_BLOCK:
+            t->status[event->slot] = BLOCKING;
+            break;
+        case SCHED_TERMINATE:
+            t->status[event->slot] = TERMINATED;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * status is what the processes start the run as, the run's events keep the
+ * timeline's own copy of it up to date once it is subscribed
+ */
+void timeline_init(Timeline *t, FILE *out, int style, int mode, int summary_format,
+                   Process **process_list, const int *status, int no_of_processes) {
+    int slot;
+    memset(t, 0, sizeof(Timeline));
+    t->out = out;
+    t->style = style;
+    t->mode = mode;
+    t->summary_format = summary_format;
+    t->turnaround_count = -1;
+    t->buffer = malloc(TIMELINE_BUFFER_SIZE);
+    INSTRUMENT_COUNT(allocations);
+    t->run_start = t->last_tick = t->last_written = -1;
+    if (mode == TIMELINE_NONE) {
+        // no slot is ever looked at
+        return;
+    }
+
+    t->no_of_processes = no_of_processes;
+    grow_slots(t, no_of_processes);
+    for (slot = 0; slot < no_of_processes; slot++) {
+        t->ids[slot] = process_list[slot]->process_id;
+        t->states[slot] = -1;
+        t->status[slot] = status[slot];
+    }
+    init_event_sink(&t->sink, timeline_event, t, NULL);
+    t->line_capacity = 256;
+    t->line = malloc(t->line_capacity);
+    INSTRUMENT_COUNT(allocations);
+    t->line_dirty = 1;
+
+    if (mode != TIMELINE_FULL) {
+        append_string(t, style == FCFS_TIMELINE ? "# timeline fcfs " : "# timeline rr ");
+        append_string(t, mode == TIMELINE_DELTA ? "delta\n" : "rle\n");
+    }
+}
+
+/**
+ * Writes the state of the processes at this tick
+ */
+void timeline_tick(Timeline *t, int tick) {
+    const int *status = t->status;
+    const int *states = t->states;
+    int *changed = t->changed;
+    int slot, i, state, changed_count = 0;
+
+    if (t->mode == TIMELINE_NONE) {
+        return;
+    }
+    INSTRUMENT_BEGIN(OUTPUT_TIMING);
+
+    // a branch free sweep over both arrays, every slot is written and only changed ones are kept
+    for (slot = 0; slot < t->no_of_processes; slot++) {
+        changed[changed_count] = slot;
+        changed_count += shown_state(status[slot]) != states[slot];
+    }
+    t->changed_count = changed_count;
+
+    if (t->mode == TIMELINE_DELTA && (t->changed_count > 0 || t->last_written == -1)) {
+        append_int(t, tick);
+        append(t, ":", 1);
+        for (i = 0; i < t->changed_count; i++) {
+            slot = t->changed[i];
+            state = shown_state(status[slot]);
+            append(t, " ", 1);
+            append_int(t, slot);
+            append(t, "/", 1);
+            append_int(t, t->ids[slot]);
+            append(t, ": ", 2);
+            append_string(t, state == -1 ? "-" : state_names[state]);
+        }
+        append(t, "\n", 1);
+        t->last_written = tick;
+    } else if (t->mode == TIMELINE_RUN_LENGTH && (t->changed_count > 0 || t->run_start == -1)) {
+        // the run so far still has the old states
+        write_run(t);
+        t->run_start = tick;
+    }
+
+    for (i = 0; i < t->changed_count; i++) {
+        slot = t->changed[i];
+        t->states[slot] = shown_state(status[slot]);
+        t->line_dirty = 1;
+    }
+    if (t->mode == TIMELINE_FULL) {
+        write_full_line(t, tick);
+    }
+    t->last_tick = tick;
+    INSTRUMENT_END(OUTPUT_TIMING);
+}
+
+/**
+ * Writes the ticks in [from_tick, to_tick) as repeats of the last one
+ */
+void timeline_repeat(Timeline *t, int from_tick, int to_tick) {
+    int tick;
+    if (to_tick <= from_tick || t->mode == TIMELINE_NONE) {
+        return;
+    }
+    INSTRUMENT_BEGIN(OUTPUT_TIMING);
+    if (t->mode == TIMELINE_FULL) {
+        for (tick = from_tick; tick < to_tick; tick++) {
+            write_full_line(t, tick);
+        }
+    }
+    t->last_tick = to_tick - 1;
+    INSTRUMENT_END(OUTPUT_TIMING);
+}
+
+static void append_double(Timeline *t, double value) {
+    char text[64];
+    int size = snprintf(text, sizeof(text), "%f", value);
+    append(t, text, size < (int) sizeof(text) ? size : (int) sizeof(text) - 1);
+}
+
+/**
+ * Ends the timeline and lets turnarounds be written as processes finish,
+ * timeline_summary then comes last
+ */
+void timeline_start_results(Timeline *t) {
+    close_ticks(t);
+    t->results_first = 1;
+    t->turnaround_count = 0;
+    if (t->summary_format == SUMMARY_CSV) {
+        append_string(t, "metric,process_id,value\n");
+    } else if (t->summary_format == SUMMARY_JSON) {
+        append_string(t, "{\"turnarounds\": [");
+    }
+}
+
+/**
+ * Ends the timeline and starts the summary with the finishing time and utilization
+ */
+void timeline_summary(Timeline *t, int finishing_time, double utilization) {
+    close_ticks(t);
+    if (!t->results_first) {
+        t->turnaround_count = 0;
+    }
+
+    switch (t->summary_format) {
+        case SUMMARY_CSV:
+            append_string(t, t->results_first ? "finishing_time,," : "metric,process_id,value\nfinishing_time,,");
+            append_int(t, finishing_time);
+            append_string(t, "\ncpu_utilization,,");
+            append_double(t, utilization);
+            append(t, "\n", 1);
+            break;
+        case SUMMARY_JSON:
+            append_string(t, t->results_first ? "], \"finishing_time\": " : "{\"finishing_time\": ");
+            append_int(t, finishing_time);
+            append_string(t, ", \"cpu_utilization\": ");
+            // nan and inf are not json
+            if (isfinite(utilization)) {
+                append_double(t, utilization);
+            } else {
+                append_string(t, "null");
+            }
+            break;
+        default:
+            append_string(t, "Finishing Time: ");
+            append_int(t, finishing_time);
+            append_string(t, "\nCPU Utilization: ");
+            append_double(t, utilization);
+            append(t, "\n", 1);
+            break;
+    }
+}
+
+/**
+ * Adds one cpu's utilization and migrations to the summary, written after
+ * timeline_summary and before any turnaround
+ */
+void timeline_cpu(Timeline *t, int cpu, double utilization, int migrations) {
+    switch (t->summary_format) {
+        case SUMMARY_CSV:
+            append_string(t, "cpu");
+            append_int(t, cpu);
+            append_string(t, "_utilization,,");
+            append_double(t, utilization);
+            append_string(t, "\ncpu");
+            append_int(t, cpu);
+            append_string(t, "_migrations,,");
+            append_int(t, migrations);
+            append(t, "\n", 1);
+            break;
+        case SUMMARY_JSON:
+            append_string(t, t->cpu_count > 0 ? ", {\"cpu\": " : ", \"cpus\": [{\"cpu\": ");
+            append_int(t, cpu);
+            append_string(t, ", \"cpu_utilization\": ");
+            if (isfinite(utilization)) {
+                append_double(t, utilization);
+            } else {
+                append_string(t, "null");
+            }
+            append_string(t, ", \"migrations\": ");
+            append_int(t, migrations);
+            append(t, "}", 1);
+            break;
+        default:
+            append_string(t, "CPU ");
+            append_int(t, cpu);
+            append_string(t, " Utilization: ");
+            append_double(t, utilization);
+            append_string(t, " Migrations: ");
+            append_int(t, migrations);
+            append(t, "\n", 1);
+            break;
+    }
+    t->cpu_count++;
+}
+
+// closes the cpu list if there is one and opens the json turnaround list
+static void open_turnarounds(Timeline *t) {
+    if (t->cpu_count > 0) {
+        append(t, "]", 1);
+    }
+    append_string(t, ", \"turnarounds\": [");
+}
+
+void timeline_turnaround(Timeline *t, int process_id, int turnaround) {
+    if (t->summary_format == SUMMARY_JSON && t->turnaround_count == 0 && !t->results_first) {
+        open_turnarounds(t);
+    }
+    switch (t->summary_format) {
+        case SUMMARY_CSV:
+            append_string(t, "turnaround,");
+            append_int(t, process_id);
+            append(t, ",", 1);
+            append_int(t, turnaround);
+            append(t, "\n", 1);
+            break;
+        case SUMMARY_JSON:
+            append_string(t, t->turnaround_count > 0 ? ", {\"process_id\": " : "{\"process_id\": ");
+            append_int(t, process_id);
+            append_string(t, ", \"turnaround\": ");
+            append_int(t, turnaround);
+            append(t, "}", 1);
+            break;
+        default:
+            append_string(t, "Turnaround process ");
+            append_int(t, process_id);
+            append(t, ": ", 2);
+            append_int(t, turnaround);
+            append(t, "\n", 1);
+            break;
+    }
+    t->turnaround_count++;
+}
+
+/**
+ * Adds the summary of one latency histogram, written after the turnarounds
+ * and, in a streamed run, after timeline_summary. key names it in csv and
+ * json, label in text
+ */
+void timeline_latency(Timeline *t, const char *key, const char *label, const LatencySummary *latency) {
+    const char *names[] = {"p50", "p90", "p99", "p99.9", "max"};
+    int values[] = {latency->p50, latency->p90, latency->p99, latency->p999, latency->max};
+    int i;
+    if (t->summary_format == SUMMARY_JSON && t->latency_count == 0 && !t->results_first) {
+        // the turnaround list is closed here instead of in timeline_finish
+        if (t->turnaround_count == 0) {
+            open_turnarounds(t);
+        }
+        append(t, "]", 1);
+    }
+    switch (t->summary_format) {
+        case SUMMARY_CSV:
+            append_string(t, key);
+            append_string(t, "_mean,,");
+            append_double(t, latency->mean);
+            append(t, "\n", 1);
+            for (i = 0; i < 5; i++) {
+                append_string(t, key);
+                append(t, "_", 1);
+                append_string(t, names[i]);
+                append_string(t, ",,");
+                append_int(t, values[i]);
+                append(t, "\n", 1);
+            }
+            break;
+        case SUMMARY_JSON:
+            append_string(t, ", \"");
+            append_string(t, key);
+            append_string(t, "\": {\"mean\": ");
+            append_double(t, latency->mean);
+            for (i = 0; i < 5; i++) {
+                append_string(t, ", \"");
+                append_string(t, names[i]);
+                append_string(t, "\": ");
+                append_int(t, values[i]);
+            }
+            append(t, "}", 1);
+            break;
+        default:
+            append_string(t, label);
+            append_string(t, ": mean ");
+            append_double(t, latency->mean);
+            for (i = 0; i < 5; i++) {
+                append(t, " ", 1);
+                append_string(t, names[i]);
+                append(t, " ", 1);
+                append_int(t, values[i]);
+            }
+            append(t, "\n", 1);
+            break;
+    }
+    t->latency_count++;
+}
+
+// ends the json object of the summary if one was started
+static void close_summary(Timeline *t) {
+    if (t->summary_format == SUMMARY_JSON && (t->results_first || t->latency_count > 0)) {
+        append(t, "}\n", 2);
+    } else if (t->summary_format == SUMMARY_JSON && t->turnaround_count != -1) {
+        if (t->turnaround_count == 0) {
+            open_turnarounds(t);
+        }
+        append(t, "]}\n", 3);
+    }
+}
+
+/**
+ * Ends the summary written so far so that another one can follow, for runs
+ * that write one summary per workload. Text and csv summaries are separated
+ * by a blank line, json ones are an object per line
+ */
+void timeline_next_summary(Timeline *t) {
+    close_ticks(t);
+    close_summary(t);
+    if (t->summary_format != SUMMARY_JSON) {
+        append(t, "\n", 1);
+    }
+    t->turnaround_count = -1;
+    t->cpu_count = 0;
+    t->latency_count = 0;
+}
+
+/**
+ * Writes out everything still buffered, the output file is left open
+ */
+void timeline_finish(Timeline *t) {
+    INSTRUMENT_BEGIN(OUTPUT_TIMING);
+    close_ticks(t);
+    close_summary(t);
+    flush_buffer(t);
+    // a writer's output is flushed by its own thread
+    if (t->out != NULL && t->writer == NULL) {
+        fflush(t->out);
+    }
+    INSTRUMENT_END(OUTPUT_TIMING);
+    free(t->buffer);
+    free(t->ids);
+    free(t->states);
+    free(t->changed);
+    free(t->shown);
+    free(t->status);
+    free(t->line);
+    memset(t, 0, sizeof(Timeline));
+}
+
+static int parse_state(const char **cursor) {
+    int state;
+    const char *p = *cursor;
+    if (*p == '-') {
+        *cursor = p + 1;
+        return -1;
+    }
+    for (state = 0; state < 3; state++) {
+        size_t size = strlen(state_names[state]);
+        if (strncmp(p, state_names[state], size) == 0) {
+            *cursor = p + size;
+            return state;
+        }
+    }
+    return -2;
+}
+
+static int parse_int(const char **cursor, int *value) {
+    char *end;
+    long result = strtol(*cursor, &end, 10);
+    if (end == *cursor) {
+        return 0;
+    }
+    *value = (int) result;
+    *cursor = end;
+    return 1;
+}
+
+static void skip_blanks(const char **cursor) {
+    while (**cursor == ' ') {
+        (*cursor)++;
+    }
+}
+
+/**
+ * Expands a delta or run-length timeline from in into the full format on out,
+ * full timelines are copied as they are
+ * returns 0, or -1 on a line it can't make sense of
+ */
+int timeline_decode(FILE *in, FILE *out) {
+    char *text = NULL;
+    size_t text_capacity = 0;
+    ssize_t text_length;
+    char style[16], mode[16];
+    const char *cursor;
+    Timeline t;
+    int capacity = 0, tick = 0, last, slot, id, state, result = 0;
+
+    text_length = getline(&text, &text_capacity, in);
+    if (text_length < 0) {
+        free(text);
+        return 0;
+    }
+    if (sscanf(text, "# timeline %15s %15s", style, mode) != 2) {
+        // already in the full format
+        do {
+            fwrite(text, 1, text_length, out);
+        } while ((text_length = getline(&text, &text_capacity, in)) >= 0);
+        free(text);
+        return 0;
+    }
+
+    // the slots are filled in from the input instead of a process list
+    memset(&t, 0, sizeof(Timeline));
+    t.out = out;
+    t.style = strcmp(style, "rr") == 0 ? RR_TIMELINE : FCFS_TIMELINE;
+    t.mode = TIMELINE_FULL;
+    t.turnaround_count = -1;
+    t.buffer = malloc(TIMELINE_BUFFER_SIZE);
+    t.line_capacity = 256;
+    t.line = malloc(t.line_capacity);
+    t.line_dirty = 1;
+    last = -1;
+
+    while (result == 0 && (text_length = getline(&text, &text_capacity, in)) >= 0) {
+        cursor = text;
+        if (*cursor < '0' || *cursor > '9') {
+            append(&t, text, text_length);
+            continue;
+        }
+        parse_int(&cursor, &tick);
+
+        if (strcmp(mode, "rle") == 0) {
+            // first-last: id: state ...
+            if (*cursor++ != '-' || !parse_int(&cursor, &last) || *cursor++ != ':') {
+                result = -1;
+                break;
+            }
+            t.no_of_processes = 0;
+            skip_blanks(&cursor);
+            while (*cursor != '\n' && *cursor != '\0') {
+                if (t.no_of_processes == capacity) {
+                    capacity = capacity == 0 ? 64 : capacity * 2;
+                    grow_slots(&t, capacity);
+                }
+                if (!parse_int(&cursor, &id) || *cursor++ != ':' || *cursor++ != ' ' ||
+                    (state = parse_state(&cursor)) < 0) {
+                    result = -1;
+                    break;
+                }
+                t.ids[t.no_of_processes] = id;
+                t.states[t.no_of_processes++] = state;
+                skip_blanks(&cursor);
+            }
+            t.line_dirty = 1;
+            for (; result == 0 && tick <= last; tick++) {
+                write_full_line(&t, tick);
+            }
+            continue;
+        }
+
+        // tick: slot/id: state ..., the ticks skipped look like the last one
+        if (*cursor++ != ':') {
+            result = -1;
+            break;
+        }
+        if (last != -1) {
+            for (last++; last < tick; last++) {
+                write_full_line(&t, last);
+            }
+        }
+        skip_blanks(&cursor);
+        while (*cursor != '\n' && *cursor != '\0') {
+            if (!parse_int(&cursor, &slot) || slot < 0 || *cursor++ != '/' || !parse_int(&cursor, &id) ||
+                *cursor++ != ':' || *cursor++ != ' ' || (state = parse_state(&cursor)) == -2) {
+                result = -1;
+                break;
+            }
+            if (slot >= t.no_of_processes) {
+                if (slot >= capacity) {
+                    while (slot >= capacity) {
+                        capacity = capacity == 0 ? 64 : capacity * 2;
+                    }
+                    grow_slots(&t, capacity);
+                }
+                while (t.no_of_processes <= slot) {
+                    t.states[t.no_of_processes++] = -1;
+                }
+            }
+            t.ids[slot] = id;
+            t.states[slot] = state;
+            t.line_dirty = 1;
+            skip_blanks(&cursor);
+        }
+        write_full_line(&t, tick);
+        last = tick;
+    }
+
+    flush_buffer(&t);
+    free(t.buffer);
+    free(t.ids);
+    free(t.states);
+    free(t.changed);
+    free(t.shown);
+    free(t.line);
+    free(text);
+    return result;
+}
@@ -0,0 +1,89 @@
+/**
+ * Timeline Writer
+ */
+
+#ifndef SCHEDULERS_TIMELINE_H
+#define SCHEDULERS_TIMELINE_H
+#include <stdio.h>
+#include "process.h"
+#include "histogram.h"
+#include "pipeline.h"
+#include "sched_events.h"
+
+// FCFS lines look like "tick: id: state ...", RR lines like "tick | id: state ..."
+enum TimelineStyle {FCFS_TIMELINE, RR_TIMELINE};
+
+/* TIMELINE_FULL writes every tick the way the schedulers always have,
+ * TIMELINE_NONE nothing but the summary, without looking at a single tick.
+ * The other modes start with a "# timeline <fcfs|rr> <delta|rle>" line:
+ *   delta  "tick: slot/id: state ..." only for ticks where some process
+ *          changed, slot being its index in the process list and state "-"
+ *          once it is no longer shown; the last tick is always written
+ *   rle    "first-last: id: state ..." once per run of identical ticks
+ * Anything after the timeline (finishing time, turnarounds) is written as is.
+ * timeline_decode expands both back into the full format.
+ */
+enum TimelineMode {TIMELINE_FULL, TIMELINE_DELTA, TIMELINE_RUN_LENGTH, TIMELINE_NONE};
+
+/* The summary after the timeline:
+ *   text  "Finishing Time: ...", "CPU Utilization: ..." and "Turnaround process id: ..." lines
+ *   csv   metric,process_id,value rows, process_id only set for turnarounds
+ *   json  {"finishing_time": ..., "cpu_utilization": ..., "turnarounds": [{"process_id": ..., "turnaround": ...}]}
+ * Multi cpu runs add "CPU n Utilization: ... Migrations: ..." lines, cpun_utilization
+ * and cpun_migrations rows or a "cpus": [{"cpu": ..., "cpu_utilization": ..., "migrations": ...}]
+ * list before the turnarounds. Streamed runs write each turnaround as the process
+ * finishes and the finishing time and utilization last.
+ * Latency summaries come after all of it as "Waiting Time: mean ... p50 ... p90 ...
+ * p99 ... p99.9 ... max ..." lines, waiting_mean, waiting_p50, ... rows or
+ * "waiting": {"mean": ..., "p50": ..., ...} keys, the same for response and turnaround.
+ */
+enum SummaryFormat {SUMMARY_TEXT, SUMMARY_CSV, SUMMARY_JSON};
+
+// output is collected here and written out in chunks of this size
+#define TIMELINE_BUFFER_SIZE (1 << 20)
+
+typedef struct Timeline {
+    FILE *out; // NULL drops the output
+    OutputWriter *writer; // if set, full buffers go to its thread instead of out
+    int style;
+    int mode;
+    int summary_format;
+    int turnaround_count; // turnarounds written so far, -1 until the summary starts
+    int cpu_count; // per cpu summaries written so far
+    int results_first; // turnarounds written before the summary, see timeline_start_results
+    int latency_count; // latency summaries written so far
+    char *buffer;
+    size_t length;
+    int *status; // by process list slot, the status of every process as the run's events left it
+    EventSink sink; // gets the run's events for status, see subscribe_timeline in scheduler.h
+    int no_of_processes;
+    int *ids; // per process list slot
+    int *states; // per process list slot, the state written last or -1 if not shown
+    int *changed; // slots whose state changed at the current tick
+    int changed_count;
+    int *shown; // slots shown in the current line, in process list order
+    int shown_count;
+    char *line; // the shown processes rendered as "id: state ...", rebuilt when states change
+    size_t line_length;
+    size_t line_capacity;
+    int line_dirty;
+    int run_start; // first tick of the run not written yet in rle mode, -1 if none
+    int last_tick;
+    int last_written;
+} Timeline;
+
+void timeline_init(Timeline *t, FILE *out, int style, int mode, int summary_format,
+                   Process **process_list, const int *status, int no_of_processes);
+void timeline_tick(Timeline *t, int tick);
+void timeline_repeat(Timeline *t, int from_tick, int to_tick);
+void timeline_start_results(Timeline *t);
+void timeline_summary(Timeline *t, int finishing_time, double utilization);
+void timeline_cpu(Timeline *t, int cpu, double utilization, int migrations);
+void timeline_turnaround(Timeline *t, int process_id, int turnaround);
+void timeline_latency(Timeline *t, const char *key, const char *label, const LatencySummary *latency);
+void timeline_next_summary(Timeline *t);
+void timeline_finish(Timeline *t);
+
+int timeline_decode(FILE *in, FILE *out);
+
+#endif //SCHEDULERS_TIMELINE_H
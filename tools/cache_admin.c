@@ -0,0 +1,39 @@
+/**
+ * Cache Admin
+ *
+ * Looks after a result cache written by --cache: verify reads every result
+ * back and removes the damaged ones and files left by runs that stopped
+ * halfway through writing theirs, purge removes every result.
+ *
+ * build: make cache_admin
+ * run:   ./cache_admin directory verify|purge
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "../result_cache.h"
+
+int main(int argc, char* argv[]) {
+    ResultCache cache = {NULL, DEFAULT_CACHE_SIZE};
+    int result;
+
+    if (argc != 3 || (strcmp(argv[2], "verify") != 0 && strcmp(argv[2], "purge") != 0)) {
+        printf("usage: %s directory verify|purge\n", argv[0]);
+        return 1;
+    }
+    cache.directory = argv[1];
+
+    if (strcmp(argv[2], "verify") == 0) {
+        result = verify_result_cache(&cache, stdout);
+    } else {
+        result = purge_result_cache(&cache);
+        if (result >= 0) {
+            printf("%d files removed\n", result);
+        }
+    }
+    if (result == CACHE_NOT_FOUND) {
+        printf("%s is not a result cache\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
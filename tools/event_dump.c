@@ -0,0 +1,106 @@
+/**
+ * Event Dump
+ *
+ * Runs a processes info file through the scheduler library and prints every
+ * scheduling event as "tick event process_id", the way a program embedding
+ * the library would see them. With --ring the events are popped on a thread
+ * of their own instead of handed to a callback.
+ *
+ * build: make event_dump
+ * run:   ./event_dump alg_type quantum file [--engine=event|tick|policy] [--ring]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../libsched.h"
+
+#define EVENT_RING_SIZE 4096
+
+static void print_event(const SchedEvent *event, void *data) {
+    fprintf((FILE*) data, "%d %s %d\n", event->tick, sched_event_name(event->type), event->process_id);
+}
+
+static void* ring_consumer(void *arg) {
+    SpscRing *ring = arg;
+    SchedEvent event;
+    while (spsc_pop(ring, &event)) {
+        print_event(&event, stdout);
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    Workload workload;
+    SchedulerContext context;
+    EventSink sink;
+    SpscRing ring;
+    pthread_t consumer;
+    int engine = EVENT_ENGINE, use_ring = 0, arg;
+
+    if (argc < 4) {
+        printf("usage: %s alg_type quantum file [--engine=event|tick|policy] [--ring]\n", argv[0]);
+        return 1;
+    }
+    for (arg = 4; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--engine=tick") == 0) {
+            engine = TICK_ENGINE;
+        } else if (strcmp(argv[arg], "--engine=event") == 0) {
+            engine = EVENT_ENGINE;
+        } else if (strcmp(argv[arg], "--engine=policy") == 0) {
+            engine = POLICY_ENGINE;
+        } else if (strcmp(argv[arg], "--ring") == 0) {
+            use_ring = 1;
+        } else {
+            printf("unknown argument %s\n", argv[arg]);
+            return 1;
+        }
+    }
+
+    if (load_workload(&workload, argv[3]) != LOAD_OK) {
+        printf("%s could not be loaded\n", argv[3]);
+        return 1;
+    }
+    if (!workload.sorted) {
+        sort_process_list(workload.process_list, workload.no_of_processes);
+    }
+    if (!init_scheduler_context(&context, workload.process_list, workload.no_of_processes)) {
+        printf("%s could not be loaded\n", argv[3]);
+        free_workload(&workload);
+        return 1;
+    }
+    context.alg_type = atoi(argv[1]);
+    if (context.alg_type < FCFS_ALGORITHM || context.alg_type > MLFQ_ALGORITHM) {
+        context.alg_type = RR_ALGORITHM;
+    }
+    context.quantum = atoi(argv[2]);
+    context.engine = engine;
+    if (workload.bursts.length > 0) {
+        context.bursts = workload.bursts.bytes;
+    }
+
+    if (use_ring) {
+        if (!init_spsc_ring(&ring, EVENT_RING_SIZE, sizeof(SchedEvent)) ||
+            pthread_create(&consumer, NULL, ring_consumer, &ring) != 0) {
+            printf("event ring could not be started\n");
+            free_scheduler_context(&context);
+            free_workload(&workload);
+            return 1;
+        }
+        init_event_sink(&sink, NULL, NULL, &ring);
+    } else {
+        init_event_sink(&sink, print_event, stdout, NULL);
+    }
+    context.events = &sink;
+    run_scheduler(&context);
+
+    if (use_ring) {
+        spsc_close(&ring);
+        pthread_join(consumer, NULL);
+        free_spsc_ring(&ring);
+    }
+    free_scheduler_context(&context);
+    free_workload(&workload);
+    return 0;
+}
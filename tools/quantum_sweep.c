@@ -0,0 +1,86 @@
+/**
+ * Quantum Sweep
+ *
+ * Runs FCFS, SJF, SRTF and priority once and RR for every quantum in
+ * [first, last] over the same processes info file, spread over all cores,
+ * and prints one csv table. With --shared-prefix the RR runs are simulated
+ * together up to the tick their quanta first make a difference.
+ *
+ * build: make quantum_sweep
+ * run:   ./quantum_sweep file first_quantum last_quantum [--threads=N] [--engine=event|tick|policy]
+ *            [--shared-prefix]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../loader.h"
+#include "../sweep.h"
+
+// run once each before the rr quanta
+static const int single_runs[] = {FCFS_ALGORITHM, SJF_ALGORITHM, SRTF_ALGORITHM, PRIORITY_ALGORITHM};
+#define NO_OF_SINGLE_RUNS ((int) (sizeof(single_runs) / sizeof(single_runs[0])))
+
+int main(int argc, char* argv[]) {
+    Workload workload;
+    SweepRun *runs;
+    int first, last, no_of_runs, no_of_threads = 0, engine = EVENT_ENGINE, shared_prefix = 0;
+    int arg, i, failed;
+
+    if (argc < 4) {
+        printf("usage: %s file first_quantum last_quantum [--threads=N] [--engine=event|tick|policy] "
+               "[--shared-prefix]\n", argv[0]);
+        return 1;
+    }
+    first = atoi(argv[2]);
+    last = atoi(argv[3]);
+    if (first < 1 || last < first) {
+        printf("invalid quantum range %s %s\n", argv[2], argv[3]);
+        return 1;
+    }
+    for (arg = 4; arg < argc; arg++) {
+        if (strncmp(argv[arg], "--threads=", 10) == 0) {
+            no_of_threads = atoi(argv[arg] + 10);
+        } else if (strcmp(argv[arg], "--engine=tick") == 0) {
+            engine = TICK_ENGINE;
+        } else if (strcmp(argv[arg], "--engine=event") == 0) {
+            engine = EVENT_ENGINE;
+        } else if (strcmp(argv[arg], "--engine=policy") == 0) {
+            engine = POLICY_ENGINE;
+        } else if (strcmp(argv[arg], "--shared-prefix") == 0) {
+            shared_prefix = 1;
+        } else {
+            printf("unknown argument %s\n", argv[arg]);
+            return 1;
+        }
+    }
+
+    if (load_workload(&workload, argv[1]) != LOAD_OK) {
+        printf("%s could not be loaded\n", argv[1]);
+        return 1;
+    }
+    if (!workload.sorted) {
+        sort_process_list(workload.process_list, workload.no_of_processes);
+    }
+
+    no_of_runs = NO_OF_SINGLE_RUNS + last - first + 1;
+    runs = calloc(no_of_runs, sizeof(SweepRun));
+    for (i = 0; i < no_of_runs; i++) {
+        if (i < NO_OF_SINGLE_RUNS) {
+            runs[i].alg_type = single_runs[i];
+            runs[i].quantum = 0;
+        } else {
+            runs[i].alg_type = RR_ALGORITHM;
+            runs[i].quantum = first + i - NO_OF_SINGLE_RUNS;
+        }
+        runs[i].engine = engine;
+    }
+
+    failed = run_sweep(workload.process_list, workload.bursts.length > 0 ? workload.bursts.bytes : NULL,
+                       workload.no_of_processes, runs, no_of_runs, no_of_threads, shared_prefix);
+    write_sweep_table(stdout, runs, no_of_runs);
+
+    free(runs);
+    free_workload(&workload);
+    return failed == 0 ? 0 : 1;
+}
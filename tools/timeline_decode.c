@@ -0,0 +1,40 @@
+/**
+ * Timeline Decoder
+ *
+ * Expands a timeline written with --timeline=delta or --timeline=rle back
+ * into the full format FCFS.out and the RR output have always used.
+ *
+ * build: make timeline_decode
+ * run:   ./timeline_decode [input [output]]
+ */
+#include <stdio.h>
+
+#include "../timeline.h"
+
+int main(int argc, char* argv[]) {
+    FILE *in = stdin, *out = stdout;
+    int result;
+
+    if (argc > 1 && (in = fopen(argv[1], "r")) == NULL) {
+        printf("%s not found\n", argv[1]);
+        return 1;
+    }
+    if (argc > 2 && (out = fopen(argv[2], "w")) == NULL) {
+        printf("%s could not be written\n", argv[2]);
+        fclose(in);
+        return 1;
+    }
+
+    result = timeline_decode(in, out);
+    if (result != 0) {
+        fprintf(stderr, "Malformed timeline\n");
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return result == 0 ? 0 : 1;
+}
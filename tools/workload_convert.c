@@ -0,0 +1,66 @@
+/**
+ * Workload Converter
+ *
+ * Converts a processes info file into a binary workload, sorted the way the
+ * schedulers expect it so loading it skips the sort, and back into text.
+ *
+ * build: make workload_convert
+ * run:   ./workload_convert to-binary processes.txt processes.bin
+ *        ./workload_convert to-text processes.bin processes.txt
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "../loader.h"
+
+int main(int argc, char* argv[]) {
+    Workload workload;
+    FILE *out;
+    int load_result, i;
+
+    if (argc != 4 || (strcmp(argv[1], "to-binary") != 0 && strcmp(argv[1], "to-text") != 0)) {
+        printf("usage: %s to-binary|to-text input output\n", argv[0]);
+        return 1;
+    }
+
+    load_result = load_workload(&workload, argv[2]);
+    if (load_result == LOAD_NOT_FOUND) {
+        printf("%s not found\n", argv[2]);
+        return 1;
+    } else if (load_result != LOAD_OK) {
+        printf("%s could not be loaded\n", argv[2]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "to-binary") == 0) {
+        if (!workload.sorted) {
+            sort_process_list(workload.process_list, workload.no_of_processes);
+        }
+        if (save_workload(&workload, argv[3], WORKLOAD_SORTED) != LOAD_OK) {
+            printf("%s could not be written\n", argv[3]);
+            free_workload(&workload);
+            return 1;
+        }
+    } else {
+        out = fopen(argv[3], "w");
+        if (out == NULL) {
+            printf("%s could not be written\n", argv[3]);
+            free_workload(&workload);
+            return 1;
+        }
+        for (i = 0; i < workload.no_of_processes; i++) {
+            Process *process = workload.process_list[i];
+            if (process->priority != 0) {
+                fprintf(out, "%d %d %d %d %d\n", process->process_id, process->cpu_time,
+                        process->io_time, process->arrival_time, process->priority);
+            } else {
+                fprintf(out, "%d %d %d %d\n", process->process_id, process->cpu_time,
+                        process->io_time, process->arrival_time);
+            }
+        }
+        fclose(out);
+    }
+
+    free_workload(&workload);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * Workload Generator
+ *
+ * Writes a seeded processes info file to stdout.
+ *
+ * build: make workload_gen
+ * run:   ./workload_gen count [--seed=N] [--arrivals=poisson|bursty] [--rate=R]
+ *                       [--bursts=uniform|pareto] [--cpu=MEAN] [--io=MEAN] [--io-ratio=F] [--max-burst=N]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../generator.h"
+
+static char out_buffer[1 << 20];
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    int arg;
+
+    if (argc < 2) {
+        printf("usage: %s count [--seed=N] [--arrivals=poisson|bursty] [--rate=R] [--bursts=uniform|pareto] "
+               "[--cpu=MEAN] [--io=MEAN] [--io-ratio=F] [--max-burst=N]\n", argv[0]);
+        return 1;
+    }
+    default_generator_options(&options);
+    options.no_of_processes = atoll(argv[1]);
+    for (arg = 2; arg < argc; arg++) {
+        if (strncmp(argv[arg], "--seed=", 7) == 0) {
+            options.seed = strtoull(argv[arg] + 7, NULL, 10);
+        } else if (strcmp(argv[arg], "--arrivals=poisson") == 0) {
+            options.arrivals = POISSON_ARRIVALS;
+        } else if (strcmp(argv[arg], "--arrivals=bursty") == 0) {
+            options.arrivals = BURSTY_ARRIVALS;
+        } else if (strncmp(argv[arg], "--rate=", 7) == 0) {
+            options.arrival_rate = atof(argv[arg] + 7);
+        } else if (strcmp(argv[arg], "--bursts=uniform") == 0) {
+            options.bursts = UNIFORM_BURSTS;
+        } else if (strcmp(argv[arg], "--bursts=pareto") == 0) {
+            options.bursts = PARETO_BURSTS;
+        } else if (strncmp(argv[arg], "--cpu=", 6) == 0) {
+            options.mean_cpu = atof(argv[arg] + 6);
+        } else if (strncmp(argv[arg], "--io=", 5) == 0) {
+            options.mean_io = atof(argv[arg] + 5);
+        } else if (strncmp(argv[arg], "--io-ratio=", 11) == 0) {
+            options.io_ratio = atof(argv[arg] + 11);
+        } else if (strncmp(argv[arg], "--max-burst=", 12) == 0) {
+            options.max_burst = atoi(argv[arg] + 12);
+        } else {
+            printf("unknown argument %s\n", argv[arg]);
+            return 1;
+        }
+    }
+
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+    if (generate_workload(stdout, &options) != 0) {
+        fprintf(stderr, "invalid generator options\n");
+        return 1;
+    }
+    return 0;
+}